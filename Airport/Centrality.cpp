@@ -0,0 +1,164 @@
+#include "airlineGraph.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+using namespace std;
+
+// One worker's search arrays and its share of the totals. The search arrays
+// are reset after each source through order, so a source only pays for the
+// airports it reaches.
+struct BrandesScratch {
+    vector<int> dist;
+    vector<double> paths;       // shortest routes from the source
+    vector<double> dependency;  // Brandes delta
+    vector<uint32_t> order;     // settled airports, nearest first
+    vector<double> betweenness, distanceSum, reachCount;
+
+    explicit BrandesScratch(uint32_t n)
+        : dist(n, UNREACHED), paths(n, 0), dependency(n, 0),
+          betweenness(n, 0), distanceSum(n, 0), reachCount(n, 0) {}
+};
+
+template <class Weight, class Queue>
+void airlineGraph::brandesSource(uint32_t src, Weight weight, Queue& pq, BrandesScratch& scratch) const {
+    vector<int>& dist = scratch.dist;
+    vector<double>& paths = scratch.paths;
+    dist[src] = 0;
+    paths[src] = 1;
+    pq.push({0, src});
+
+    // Dijkstra that counts shortest routes; with positive weights every
+    // airport's count is final by the time it is settled
+    while (!pq.empty()) {
+        int d = pq.top().first;
+        uint32_t u = pq.top().second;
+        pq.pop();
+        if (d > dist[u]) continue;
+        scratch.order.push_back(u);
+        for (uint32_t e = csr.offsets[u]; e < csr.offsets[u + 1]; ++e) {
+            uint32_t v = csr.targets[e];
+            int next = d + weight(e);
+            if (next < dist[v]) {
+                dist[v] = next;
+                paths[v] = paths[u];
+                pq.push({next, v});
+            } else if (next == dist[v]) {
+                paths[v] += paths[u];
+            }
+        }
+    }
+
+    // Dependencies flow back from the farthest airports over incoming flights
+    // that lie on a shortest route, so no predecessor lists are kept
+    for (auto it = scratch.order.rbegin(); it != scratch.order.rend(); ++it) {
+        uint32_t w = *it;
+        double share = (1 + scratch.dependency[w]) / paths[w];
+        for (uint32_t slot = reverseCsr.offsets[w]; slot < reverseCsr.offsets[w + 1]; ++slot) {
+            uint32_t u = reverseCsr.targets[slot];
+            if (dist[u] != UNREACHED && dist[u] + weight(reverseEdge[slot]) == dist[w]) {
+                scratch.dependency[u] += paths[u] * share;
+            }
+        }
+        if (w != src) {
+            scratch.betweenness[w] += scratch.dependency[w];
+            scratch.distanceSum[w] += dist[w];
+            scratch.reachCount[w] += 1;
+        }
+    }
+
+    for (uint32_t v : scratch.order) {
+        dist[v] = UNREACHED;
+        paths[v] = 0;
+        scratch.dependency[v] = 0;
+    }
+    scratch.order.clear();
+}
+
+vector<Centrality> airlineGraph::brandesCentrality(const vector<uint32_t>& sources, double scale,
+                                                   const RouteMetric& metric, unsigned threads) const {
+    uint32_t n = csr.nodeCount();
+    ThreadPool pool(threads);
+
+    // Workers pull sources off a shared counter into their own accumulators
+    vector<BrandesScratch> partials(pool.size(), BrandesScratch(n));
+    atomic<size_t> nextSource(0);
+    for (unsigned t = 0; t < pool.size(); ++t) {
+        pool.submit([this, &sources, &metric, &nextSource, &partials, t]() {
+            BrandesScratch& scratch = partials[t];
+            SearchWorkspace& workspace = SearchWorkspace::local();
+            withWeightPolicy(metric, csr.distances, csr.costs, [&](auto weight) {
+                int maxStep = weight.maxStep(maxWeight[0], maxWeight[1]);
+                for (size_t i = nextSource++; i < sources.size(); i = nextSource++) {
+                    workspace.withQueues(dijkstraQueue, maxStep, [&](auto& pq, auto&) {
+                        brandesSource(sources[i], weight, pq, scratch);
+                    });
+                }
+            });
+        });
+    }
+    pool.wait();
+
+    vector<Centrality> results(n);
+    for (uint32_t v = 0; v < n; ++v) {
+        double betweenness = 0, distanceSum = 0, reachCount = 0;
+        for (const BrandesScratch& partial : partials) {
+            betweenness += partial.betweenness[v];
+            distanceSum += partial.distanceSum[v];
+            reachCount += partial.reachCount[v];
+        }
+        results[v].air_code = airportCodes[v];
+        results[v].betweenness = betweenness * scale;
+        // Wasserman-Faust: the share of airports that reach v, over their mean distance
+        reachCount *= scale;
+        distanceSum *= scale;
+        if (n > 1 && distanceSum > 0) {
+            results[v].closeness = (reachCount / (n - 1)) * (reachCount / distanceSum);
+        }
+    }
+    return results;
+}
+
+vector<Centrality> airlineGraph::centrality(const RouteMetric& metric, unsigned threads) {
+    if (!metric.valid()) {
+        cerr << "Route metric weights must be non-negative" << endl;
+        return {};
+    }
+    ensureFrozen();
+    vector<uint32_t> sources(csr.nodeCount());
+    for (uint32_t id = 0; id < sources.size(); ++id) {
+        sources[id] = id;
+    }
+    return brandesCentrality(sources, 1.0, metric, threads);
+}
+
+vector<Centrality> airlineGraph::approximateCentrality(double epsilon, double delta, const RouteMetric& metric,
+                                                       unsigned threads, uint64_t seed) {
+    if (!(epsilon > 0) || !(delta > 0 && delta < 1)) {
+        cerr << "Centrality sampling needs epsilon > 0 and 0 < delta < 1" << endl;
+        return {};
+    }
+    if (!metric.valid()) {
+        cerr << "Route metric weights must be non-negative" << endl;
+        return {};
+    }
+    ensureFrozen();
+    uint32_t n = csr.nodeCount();
+
+    // Each source's dependency on an airport lies in [0, n - 2], so Hoeffding
+    // with a union bound over the n airports gives the sample size
+    double needed = ceil(log(2.0 * max<uint32_t>(n, 1) / delta) / (2 * epsilon * epsilon));
+    if (needed >= n) {
+        return centrality(metric, threads);
+    }
+    size_t samples = static_cast<size_t>(needed);
+    mt19937_64 rng(seed);
+    uniform_int_distribution<uint32_t> pick(0, n - 1);
+    vector<uint32_t> sources(samples);
+    for (uint32_t& src : sources) {
+        src = pick(rng);
+    }
+    return brandesCentrality(sources, static_cast<double>(n) / samples, metric, threads);
+}
@@ -0,0 +1,112 @@
+#ifndef CLOCKCACHE_H
+#define CLOCKCACHE_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <unordered_map>
+#include <functional>
+
+struct CacheStats {
+    uint64_t hits, misses, evictions;
+    size_t size, capacity;
+
+    CacheStats() : hits(0), misses(0), evictions(0), size(0), capacity(0) {}
+};
+
+// Fixed-capacity map with CLOCK (second chance) replacement. Every entry is
+// stamped with the version of the data it was computed from; a lookup at a
+// newer version misses, and stale slots are the first to be reused. Only
+// live entries pushed out for space count as evictions.
+template <class Key, class Value, class Hash = std::hash<Key>>
+class ClockCache {
+    struct Slot {
+        Key key;
+        Value value;
+        uint64_t version;
+        bool referenced;
+    };
+
+    std::vector<Slot> slots;
+    std::unordered_map<Key, size_t, Hash> index;  // key -> slot
+    size_t limit;
+    size_t hand;
+    CacheStats counters;
+
+    // Sweeps from the hand, clearing reference bits, to a stale or unreferenced slot
+    size_t victim(uint64_t version) {
+        while (true) {
+            Slot& slot = slots[hand];
+            size_t at = hand;
+            hand = (hand + 1) % slots.size();
+            if (slot.version != version) return at;
+            if (!slot.referenced) {
+                counters.evictions++;
+                return at;
+            }
+            slot.referenced = false;
+        }
+    }
+
+public:
+    explicit ClockCache(size_t capacity = 0) : limit(capacity), hand(0) {}
+
+    // Cached value for key computed at this version, or nullptr. The pointer
+    // is valid until the next insert.
+    const Value* find(const Key& key, uint64_t version) {
+        auto it = index.find(key);
+        if (it == index.end() || slots[it->second].version != version) {
+            counters.misses++;
+            return nullptr;
+        }
+        counters.hits++;
+        slots[it->second].referenced = true;
+        return &slots[it->second].value;
+    }
+
+    void insert(const Key& key, const Value& value, uint64_t version) {
+        if (limit == 0) return;
+        auto it = index.find(key);
+        if (it != index.end()) {
+            Slot& slot = slots[it->second];
+            slot.value = value;
+            slot.version = version;
+            slot.referenced = true;
+            return;
+        }
+
+        size_t at;
+        if (slots.size() < limit) {
+            at = slots.size();
+            slots.push_back(Slot{key, value, version, false});
+        } else {
+            at = victim(version);
+            index.erase(slots[at].key);
+            slots[at] = Slot{key, value, version, false};
+        }
+        index.emplace(key, at);
+    }
+
+    // Drops every entry; a capacity of 0 disables caching. Counters are kept.
+    void setCapacity(size_t capacity) {
+        limit = capacity;
+        clear();
+    }
+
+    void clear() {
+        slots.clear();
+        index.clear();
+        hand = 0;
+    }
+
+    CacheStats stats() const {
+        CacheStats result = counters;
+        result.size = slots.size();
+        result.capacity = limit;
+        return result;
+    }
+
+    void resetStats() { counters = CacheStats(); }
+};
+
+#endif
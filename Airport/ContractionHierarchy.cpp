@@ -0,0 +1,319 @@
+#include "ContractionHierarchy.h"
+#include "airlineGraph.h"
+#include <algorithm>
+#include <queue>
+
+using namespace std;
+
+const uint32_t ContractionHierarchy::NO_ARC;
+
+// Witness searches give up after settling this many airports or following
+// this many arcs; a missed witness only costs an unnecessary shortcut, never
+// a wrong answer
+static const uint32_t WITNESS_SETTLE_LIMIT = 100;
+static const uint32_t WITNESS_HOP_LIMIT = 5;
+
+namespace {
+
+// Mutable state while airports are being contracted
+struct Contractor {
+    vector<vector<uint32_t>> outArcs, inArcs;
+    vector<bool> contracted;
+    vector<int> contractedNeighbors;
+    // Witness search scratch, reset through the touched list
+    vector<int> dist;
+    vector<uint32_t> hops;
+    vector<uint32_t> touched;
+    vector<bool> isTarget;
+    MinHeapBuffer heap;
+    // Cheapest arc per neighbour while one airport is being processed
+    vector<uint32_t> bestArc;
+};
+
+}
+
+uint32_t ContractionHierarchy::shortcutCount() const {
+    return static_cast<uint32_t>(arcs.size()) - originalArcs;
+}
+
+void ContractionHierarchy::build(const CSRGraph& graph, const vector<int>& weights) {
+    uint32_t n = graph.nodeCount();
+    arcs.clear();
+    rank.assign(n, 0);
+
+    Contractor state;
+    state.outArcs.resize(n);
+    state.inArcs.resize(n);
+    state.contracted.assign(n, false);
+    state.contractedNeighbors.assign(n, 0);
+    state.dist.assign(n, UNREACHED);
+    state.hops.assign(n, 0);
+    state.isTarget.assign(n, false);
+    state.bestArc.assign(n, NO_ARC);
+    for (uint32_t from = 0; from < n; ++from) {
+        for (uint32_t e = graph.offsets[from]; e < graph.offsets[from + 1]; ++e) {
+            uint32_t to = graph.targets[e];
+            if (to == from) continue;
+            state.outArcs[from].push_back(static_cast<uint32_t>(arcs.size()));
+            state.inArcs[to].push_back(static_cast<uint32_t>(arcs.size()));
+            arcs.push_back({from, to, weights[e], e, NO_ARC, NO_ARC});
+        }
+    }
+    originalArcs = static_cast<uint32_t>(arcs.size());
+
+    // Cheapest live arc per neighbour on one side of v
+    auto collect = [&](uint32_t v, bool incoming, vector<uint32_t>& result) {
+        result.clear();
+        for (uint32_t arc : incoming ? state.inArcs[v] : state.outArcs[v]) {
+            uint32_t other = incoming ? arcs[arc].tail : arcs[arc].head;
+            if (state.contracted[other]) continue;
+            uint32_t& best = state.bestArc[other];
+            if (best == NO_ARC) {
+                result.push_back(other);
+                best = arc;
+            } else if (arcs[arc].weight < arcs[best].weight) {
+                best = arc;
+            }
+        }
+        for (uint32_t& other : result) {
+            uint32_t arc = state.bestArc[other];
+            state.bestArc[other] = NO_ARC;
+            other = arc;
+        }
+    };
+
+    // Witness search from u that avoids v, bounded by the longest candidate
+    // and stopping once every out-neighbour of v is settled
+    auto witnessSearch = [&](uint32_t u, uint32_t v, int limit, uint32_t remaining) {
+        state.heap.clear();
+        state.dist[u] = 0;
+        state.hops[u] = 0;
+        state.touched.push_back(u);
+        state.heap.push({0, u});
+        uint32_t settled = 0;
+        while (!state.heap.empty() && settled < WITNESS_SETTLE_LIMIT) {
+            int d = state.heap.top().first;
+            uint32_t x = state.heap.top().second;
+            state.heap.pop();
+            if (d > state.dist[x]) continue;
+            if (d > limit) break;
+            settled++;
+            if (x != u && state.isTarget[x] && --remaining == 0) break;
+            if (state.hops[x] >= WITNESS_HOP_LIMIT) continue;
+            for (uint32_t arc : state.outArcs[x]) {
+                uint32_t y = arcs[arc].head;
+                if (y == v || state.contracted[y]) continue;
+                int nd = d + arcs[arc].weight;
+                if (nd <= limit && nd < state.dist[y]) {
+                    if (state.dist[y] == UNREACHED) state.touched.push_back(y);
+                    state.dist[y] = nd;
+                    state.hops[y] = state.hops[x] + 1;
+                    state.heap.push({nd, y});
+                }
+            }
+        }
+    };
+
+    // Shortcuts needed to contract v, left in needed for the caller to add
+    vector<uint32_t> ins, outs;
+    vector<pair<uint32_t, uint32_t>> needed;
+    auto process = [&](uint32_t v) {
+        collect(v, true, ins);
+        collect(v, false, outs);
+        needed.clear();
+        for (uint32_t out : outs) state.isTarget[arcs[out].head] = true;
+        for (uint32_t in : ins) {
+            uint32_t u = arcs[in].tail;
+            int limit = -1;
+            uint32_t remaining = 0;
+            for (uint32_t out : outs) {
+                if (arcs[out].head != u) {
+                    limit = max(limit, arcs[in].weight + arcs[out].weight);
+                    remaining++;
+                }
+            }
+            if (limit < 0) continue;
+
+            witnessSearch(u, v, limit, remaining);
+
+            for (uint32_t out : outs) {
+                uint32_t w = arcs[out].head;
+                if (w == u) continue;
+                if (state.dist[w] > arcs[in].weight + arcs[out].weight) {
+                    needed.push_back({in, out});
+                }
+            }
+            for (uint32_t x : state.touched) state.dist[x] = UNREACHED;
+            state.touched.clear();
+        }
+        for (uint32_t out : outs) state.isTarget[arcs[out].head] = false;
+        // Edge difference plus a nudge toward spreading contraction evenly
+        return static_cast<int>(needed.size()) - static_cast<int>(ins.size() + outs.size()) +
+               state.contractedNeighbors[v];
+    };
+
+    MinQueue order;
+    for (uint32_t v = 0; v < n; ++v) {
+        order.push({process(v), v});
+    }
+
+    uint32_t next = 0;
+    while (!order.empty()) {
+        uint32_t v = order.top().second;
+        order.pop();
+        if (state.contracted[v]) continue;
+
+        // Lazy update: priorities go stale as neighbours contract, so recheck
+        // before committing and requeue if v is no longer the cheapest. The
+        // recheck already found the shortcuts v needs, so they are added as is.
+        int priority = process(v);
+        if (!order.empty() && priority > order.top().first) {
+            order.push({priority, v});
+            continue;
+        }
+
+        for (const auto& pair : needed) {
+            const Arc& in = arcs[pair.first];
+            const Arc& out = arcs[pair.second];
+            uint32_t id = static_cast<uint32_t>(arcs.size());
+            Arc shortcut = {in.tail, out.head, in.weight + out.weight, NO_ARC, pair.first, pair.second};
+            arcs.push_back(shortcut);
+            state.outArcs[shortcut.tail].push_back(id);
+            state.inArcs[shortcut.head].push_back(id);
+        }
+        state.contracted[v] = true;
+        rank[v] = next++;
+        // Drop v's arcs from its neighbours' lists so later witness searches
+        // and priority checks do not keep skipping them
+        for (uint32_t arc : state.inArcs[v]) {
+            uint32_t tail = arcs[arc].tail;
+            if (state.contracted[tail]) continue;
+            state.contractedNeighbors[tail]++;
+            vector<uint32_t>& list = state.outArcs[tail];
+            list.erase(remove(list.begin(), list.end(), arc), list.end());
+        }
+        for (uint32_t arc : state.outArcs[v]) {
+            uint32_t head = arcs[arc].head;
+            if (state.contracted[head]) continue;
+            state.contractedNeighbors[head]++;
+            vector<uint32_t>& list = state.inArcs[head];
+            list.erase(remove(list.begin(), list.end(), arc), list.end());
+        }
+    }
+
+    // Split every arc into the upward graph of its lower-ranked end
+    upOffsets.assign(n + 1, 0);
+    downOffsets.assign(n + 1, 0);
+    for (const Arc& arc : arcs) {
+        if (rank[arc.head] > rank[arc.tail]) upOffsets[arc.tail + 1]++;
+        else downOffsets[arc.head + 1]++;
+    }
+    for (uint32_t i = 0; i < n; ++i) {
+        upOffsets[i + 1] += upOffsets[i];
+        downOffsets[i + 1] += downOffsets[i];
+    }
+    upArcs.resize(upOffsets[n]);
+    downArcs.resize(downOffsets[n]);
+    vector<uint32_t> upCursor(upOffsets.begin(), upOffsets.end() - 1);
+    vector<uint32_t> downCursor(downOffsets.begin(), downOffsets.end() - 1);
+    for (uint32_t id = 0; id < arcs.size(); ++id) {
+        const Arc& arc = arcs[id];
+        if (rank[arc.head] > rank[arc.tail]) upArcs[upCursor[arc.tail]++] = id;
+        else downArcs[downCursor[arc.head]++] = id;
+    }
+}
+
+int ContractionHierarchy::query(uint32_t src, uint32_t target, vector<uint32_t>& edges,
+                                SearchWorkspace& workspace) const {
+    edges.clear();
+    uint32_t n = static_cast<uint32_t>(rank.size());
+    StampedArray<SearchLabel>& labelsF = workspace.labels[0];
+    StampedArray<SearchLabel>& labelsB = workspace.labels[1];
+    MinHeapBuffer& pqF = workspace.heap[0];
+    MinHeapBuffer& pqB = workspace.heap[1];
+    labelsF.reset(n, {UNREACHED, NO_ARC});
+    labelsB.reset(n, {UNREACHED, NO_ARC});
+    pqF.clear();
+    pqB.clear();
+    labelsF.at(src).dist = 0;
+    labelsB.at(target).dist = 0;
+    pqF.push({0, src});
+    pqB.push({0, target});
+
+    int best = UNREACHED;
+    uint32_t meet = NO_ARC;
+    // Both searches only climb, so neither can stop at the first meeting;
+    // each runs until its own frontier can no longer beat the best route
+    while (!pqF.empty() || !pqB.empty()) {
+        bool forward = pqB.empty() || (!pqF.empty() && pqF.top().first <= pqB.top().first);
+        MinHeapBuffer& pq = forward ? pqF : pqB;
+        if (pq.top().first >= best) {
+            pq.clear();
+            continue;
+        }
+        StampedArray<SearchLabel>& labels = forward ? labelsF : labelsB;
+        const StampedArray<SearchLabel>& other = forward ? labelsB : labelsF;
+        int d = pq.top().first;
+        uint32_t x = pq.top().second;
+        pq.pop();
+        if (d > labels[x].dist) continue;
+        if (other[x].dist != UNREACHED && d + other[x].dist < best) {
+            best = d + other[x].dist;
+            meet = x;
+        }
+
+        // Stall on demand: if a higher airport this search already reached
+        // leads down to x more cheaply, x is not on a shortest upward route
+        // and need not be expanded
+        const vector<uint32_t>& stallOffsets = forward ? downOffsets : upOffsets;
+        const vector<uint32_t>& stallList = forward ? downArcs : upArcs;
+        bool stalled = false;
+        for (uint32_t i = stallOffsets[x]; i < stallOffsets[x + 1] && !stalled; ++i) {
+            const Arc& arc = arcs[stallList[i]];
+            const SearchLabel& above = labels[forward ? arc.tail : arc.head];
+            stalled = above.dist != UNREACHED && above.dist + arc.weight < d;
+        }
+        if (stalled) continue;
+
+        const vector<uint32_t>& offsets = forward ? upOffsets : downOffsets;
+        const vector<uint32_t>& list = forward ? upArcs : downArcs;
+        for (uint32_t i = offsets[x]; i < offsets[x + 1]; ++i) {
+            const Arc& arc = arcs[list[i]];
+            uint32_t y = forward ? arc.head : arc.tail;
+            int nd = d + arc.weight;
+            if (nd < labels[y].dist) {
+                labels.at(y) = {nd, list[i]};
+                pq.push({nd, y});
+            }
+        }
+    }
+
+    if (meet == NO_ARC) {
+        return -1;
+    }
+    vector<uint32_t> up;
+    for (uint32_t at = meet; at != src; at = arcs[labelsF[at].via].tail) {
+        up.push_back(labelsF[at].via);
+    }
+    for (auto it = up.rbegin(); it != up.rend(); ++it) {
+        unpack(*it, edges);
+    }
+    for (uint32_t at = meet; at != target; at = arcs[labelsB[at].via].head) {
+        unpack(labelsB[at].via, edges);
+    }
+    return best;
+}
+
+void ContractionHierarchy::unpack(uint32_t arc, vector<uint32_t>& edges) const {
+    vector<uint32_t> pending = {arc};
+    while (!pending.empty()) {
+        const Arc& current = arcs[pending.back()];
+        pending.pop_back();
+        if (current.edge != NO_ARC) {
+            edges.push_back(current.edge);
+        } else {
+            pending.push_back(current.second);  // popped after first, keeping route order
+            pending.push_back(current.first);
+        }
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef CONTRACTIONHIERARCHY_H
+#define CONTRACTIONHIERARCHY_H
+
+#include <vector>
+#include <cstdint>
+#include "SearchWorkspace.h"
+
+struct CSRGraph;
+
+// Contraction Hierarchy over one weighting of a frozen CSRGraph. build()
+// contracts airports in order of importance and adds shortcuts that keep
+// every shortest route intact; query() then runs a bidirectional search that
+// only climbs the order, and unpacks shortcuts back into original flights.
+class ContractionHierarchy {
+public:
+    ContractionHierarchy() {}
+
+    void build(const CSRGraph& graph, const std::vector<int>& weights);
+    bool ready() const { return !rank.empty(); }
+    uint32_t shortcutCount() const;
+
+    // Fills edges with the csr edge ids of a shortest src -> target route and
+    // returns its weight, or returns -1 when target is unreachable
+    int query(uint32_t src, uint32_t target, std::vector<uint32_t>& edges, SearchWorkspace& workspace) const;
+
+private:
+    static const uint32_t NO_ARC = UINT32_MAX;
+
+    // Original flights and shortcuts alike; a shortcut remembers the two arcs it spans
+    struct Arc {
+        uint32_t tail, head;
+        int weight;
+        uint32_t edge;           // csr edge id, or NO_ARC for a shortcut
+        uint32_t first, second;  // child arcs of a shortcut
+    };
+
+    std::vector<Arc> arcs;
+    std::vector<uint32_t> rank;  // contraction order per airport
+    uint32_t originalArcs = 0;
+    // Upward search graphs: arcs leaving each airport toward higher rank, and
+    // arcs entering each airport from higher rank (searched tail-ward)
+    std::vector<uint32_t> upOffsets, upArcs;
+    std::vector<uint32_t> downOffsets, downArcs;
+
+    void unpack(uint32_t arc, std::vector<uint32_t>& edges) const;
+};
+
+#endif
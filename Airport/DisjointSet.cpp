@@ -0,0 +1,80 @@
+#include "DisjointSet.h"
+
+using namespace std;
+
+DisjointSet::DisjointSet(int size) : parent(size), rank(size, 0) {
+    for (int i = 0; i < size; ++i) {
+        parent[i] = i;
+    }
+}
+
+int DisjointSet::find(int v) {
+    while (parent[v] != v) {
+        parent[v] = parent[parent[v]];  // path halving
+        v = parent[v];
+    }
+    return v;
+}
+
+void DisjointSet::unionSet(int u, int v) {
+    int rootU = find(u);
+    int rootV = find(v);
+    if (rootU != rootV) {
+        if (rank[rootU] < rank[rootV]) {
+            parent[rootU] = rootV;
+        } else if (rank[rootU] > rank[rootV]) {
+            parent[rootV] = rootU;
+        } else {
+            parent[rootV] = rootU;
+            rank[rootU]++;
+        }
+    }
+}
+
+ConcurrentDisjointSet::ConcurrentDisjointSet(uint32_t size)
+    : parent(new atomic<uint32_t>[size]), count(size) {
+    for (uint32_t i = 0; i < size; ++i) {
+        parent[i].store(i, memory_order_relaxed);
+    }
+}
+
+uint32_t ConcurrentDisjointSet::find(uint32_t v) {
+    while (true) {
+        uint32_t p = parent[v].load(memory_order_acquire);
+        if (p == v) return v;
+        uint32_t grandparent = parent[p].load(memory_order_acquire);
+        if (p != grandparent) {
+            // Losing this race is harmless; another thread already shortened the path
+            parent[v].compare_exchange_weak(p, grandparent, memory_order_release, memory_order_relaxed);
+        }
+        v = grandparent;
+    }
+}
+
+bool ConcurrentDisjointSet::unite(uint32_t u, uint32_t v) {
+    while (true) {
+        u = find(u);
+        v = find(v);
+        if (u == v) return false;
+        if (u < v) {
+            uint32_t tmp = u;
+            u = v;
+            v = tmp;
+        }
+        // Only a root may be linked; if u gained a parent meanwhile, retry from the top
+        uint32_t expected = u;
+        if (parent[u].compare_exchange_strong(expected, v, memory_order_acq_rel)) {
+            return true;
+        }
+    }
+}
+
+bool ConcurrentDisjointSet::sameSet(uint32_t u, uint32_t v) {
+    while (true) {
+        u = find(u);
+        v = find(v);
+        if (u == v) return true;
+        // u was a root when found; if it still is, the sets were distinct at that moment
+        if (parent[u].load(memory_order_acquire) == u) return false;
+    }
+}
@@ -0,0 +1,33 @@
+#ifndef DISJOINTSET_H
+#define DISJOINTSET_H
+
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+
+// Sequential union-find with union by rank and iterative path halving
+class DisjointSet {
+    std::vector<int> parent, rank;
+public:
+    DisjointSet(int size);
+    int find(int v);
+    void unionSet(int u, int v);
+};
+
+// Lock-free union-find that any number of threads may use at once. Roots are
+// linked by index (the larger index goes under the smaller) with a single CAS,
+// and finds halve paths with best-effort CASes, so no call ever blocks.
+class ConcurrentDisjointSet {
+    std::unique_ptr<std::atomic<uint32_t>[]> parent;
+    uint32_t count;
+public:
+    explicit ConcurrentDisjointSet(uint32_t size);
+
+    uint32_t size() const { return count; }
+    uint32_t find(uint32_t v);
+    bool unite(uint32_t u, uint32_t v);  // true if this call merged two sets
+    bool sameSet(uint32_t u, uint32_t v);
+};
+
+#endif
@@ -0,0 +1,197 @@
+#include "airlineGraph.h"
+#include <algorithm>
+#include <queue>
+
+using namespace std;
+
+// Flight updates and removals, and the incremental repair that keeps the
+// Dynamic mode's cached shortest-path trees exact across them. A change only
+// touches the airports whose distance it can actually move: a cheaper flight
+// propagates outward from its head, and a dearer or removed tree flight
+// re-seeds just the subtree that hung from it.
+
+// Dijkstra from the queued airports outward; unqueued labels are taken as final
+static void settleTree(const CSRGraph& graph, const vector<int>& weights, ShortestPathTree& tree, MinQueue& pq) {
+    while (!pq.empty()) {
+        int curDist = pq.top().first;
+        uint32_t cur = pq.top().second;
+        pq.pop();
+        if (curDist > tree.dist[cur]) continue;
+        for (uint32_t e = graph.offsets[cur]; e < graph.offsets[cur + 1]; ++e) {
+            uint32_t next = graph.targets[e];
+            if (curDist + weights[e] < tree.dist[next]) {
+                tree.dist[next] = curDist + weights[e];
+                tree.prevEdge[next] = e;
+                pq.push({tree.dist[next], next});
+            }
+        }
+    }
+}
+
+uint32_t airlineGraph::findFlight(uint32_t from, uint32_t to) const {
+    for (uint32_t e = csr.offsets[from]; e < csr.offsets[from + 1]; ++e) {
+        if (csr.targets[e] == to) return e;
+    }
+    return INVALID_AIRPORT;
+}
+
+void airlineGraph::repairDecrease(ShortestPathTree& tree, uint32_t edge, bool useCost) const {
+    const vector<int>& weights = useCost ? csr.costs : csr.distances;
+    uint32_t from = csr.edgeSource(edge);
+    uint32_t to = csr.targets[edge];
+    if (tree.dist[from] == UNREACHED || tree.dist[from] + weights[edge] >= tree.dist[to]) return;
+
+    tree.dist[to] = tree.dist[from] + weights[edge];
+    tree.prevEdge[to] = edge;
+    MinQueue pq;
+    pq.push({tree.dist[to], to});
+    settleTree(csr, weights, tree, pq);
+}
+
+void airlineGraph::repairIncrease(ShortestPathTree& tree, uint32_t root, bool useCost) const {
+    const vector<int>& weights = useCost ? csr.costs : csr.distances;
+    const vector<int>& reverseWeights = useCost ? reverseCsr.costs : reverseCsr.distances;
+
+    // Collect root's subtree: a child's tree flight leaves an airport already collected
+    tree.prevEdge[root] = INVALID_AIRPORT;
+    vector<uint32_t> affected = {root};
+    for (size_t i = 0; i < affected.size(); ++i) {
+        uint32_t cur = affected[i];
+        for (uint32_t e = csr.offsets[cur]; e < csr.offsets[cur + 1]; ++e) {
+            if (tree.prevEdge[csr.targets[e]] == e) affected.push_back(csr.targets[e]);
+        }
+    }
+    for (uint32_t v : affected) {
+        tree.dist[v] = UNREACHED;
+        tree.prevEdge[v] = INVALID_AIRPORT;
+    }
+
+    // Labels outside the subtree are unchanged, so each affected airport starts
+    // from its best incoming flight and Dijkstra settles the rest
+    MinQueue pq;
+    for (uint32_t v : affected) {
+        for (uint32_t slot = reverseCsr.offsets[v]; slot < reverseCsr.offsets[v + 1]; ++slot) {
+            uint32_t from = reverseCsr.targets[slot];
+            if (tree.dist[from] == UNREACHED) continue;
+            if (tree.dist[from] + reverseWeights[slot] < tree.dist[v]) {
+                tree.dist[v] = tree.dist[from] + reverseWeights[slot];
+                tree.prevEdge[v] = reverseEdge[slot];
+            }
+        }
+        if (tree.dist[v] != UNREACHED) {
+            pq.push({tree.dist[v], v});
+        }
+    }
+    settleTree(csr, weights, tree, pq);
+}
+
+void airlineGraph::trimDynamicTrees(bool useCost, size_t keep) {
+    // A linear scan per eviction is cheap next to the full tree build that follows
+    auto& trees = dynamicTrees[useCost];
+    while (trees.size() > keep) {
+        auto oldest = trees.begin();
+        for (auto it = trees.begin(); it != trees.end(); ++it) {
+            if (it->second.lastUsed < oldest->second.lastUsed) oldest = it;
+        }
+        trees.erase(oldest);
+    }
+}
+
+void airlineGraph::setDynamicTreeCapacity(size_t trees) {
+    dynamicTreeLimit = trees;
+    trimDynamicTrees(false, trees);
+    trimDynamicTrees(true, trees);
+}
+
+bool airlineGraph::updateFlightEdge(const string& origin, const string& dest, int dist, int cost) {
+    uint32_t from = getIndex(origin);
+    uint32_t to = getIndex(dest);
+    if (from == INVALID_AIRPORT || to == INVALID_AIRPORT) {
+        return false;
+    }
+    ensureFrozen();
+    uint32_t edge = findFlight(from, to);
+    if (edge == INVALID_AIRPORT) {
+        return false;
+    }
+
+    int oldWeight[2] = {csr.distances[edge], csr.costs[edge]};
+    int newWeight[2] = {dist, cost};
+    graphVersion++;
+    maxWeight[0] = max(maxWeight[0], dist);
+    maxWeight[1] = max(maxWeight[1], cost);
+    flights[edge].distance = dist;
+    flights[edge].cost = cost;
+    csr.distances[edge] = dist;
+    csr.costs[edge] = cost;
+    for (uint32_t slot = reverseCsr.offsets[to]; slot < reverseCsr.offsets[to + 1]; ++slot) {
+        if (reverseEdge[slot] == edge) {
+            reverseCsr.distances[slot] = dist;
+            reverseCsr.costs[slot] = cost;
+            break;
+        }
+    }
+
+    // The topology is unchanged, so the component index and reverse graph stand.
+    // A shorter flight may undercut the great-circle scale; a longer one cannot.
+    resetWeightTables();
+    if (allLocated && dist < oldWeight[0]) {
+        double miles = greatCircleMiles(from, to);
+        if (miles > 0) {
+            geoScale = min(geoScale, dist / miles * (1 - 1e-9));
+        }
+    }
+
+    for (int useCost = 0; useCost < 2; ++useCost) {
+        if (newWeight[useCost] == oldWeight[useCost]) continue;
+        for (auto& entry : dynamicTrees[useCost]) {
+            ShortestPathTree& tree = entry.second;
+            if (newWeight[useCost] < oldWeight[useCost]) {
+                repairDecrease(tree, edge, useCost);
+            } else if (tree.prevEdge[to] == edge) {
+                repairIncrease(tree, to, useCost);
+            }
+        }
+    }
+    return true;
+}
+
+bool airlineGraph::removeFlightEdge(const string& origin, const string& dest) {
+    uint32_t from = getIndex(origin);
+    uint32_t to = getIndex(dest);
+    if (from == INVALID_AIRPORT || to == INVALID_AIRPORT) {
+        return false;
+    }
+    ensureFrozen();
+    uint32_t edge = findFlight(from, to);
+    if (edge == INVALID_AIRPORT) {
+        return false;
+    }
+
+    flights.erase(flights.begin() + edge);
+    graphVersion++;
+    outDegree[from]--;
+    inDegree[to]--;
+
+    // Refreezing may split components, so it runs in full, but the trees are
+    // carried across it: later edges shift down one slot and only the subtree
+    // below the removed flight needs repair
+    unordered_map<uint32_t, ShortestPathTree> trees[2];
+    trees[0].swap(dynamicTrees[0]);
+    trees[1].swap(dynamicTrees[1]);
+    freeze();
+    for (int useCost = 0; useCost < 2; ++useCost) {
+        for (auto& entry : trees[useCost]) {
+            ShortestPathTree& tree = entry.second;
+            bool orphaned = tree.prevEdge[to] == edge;
+            for (uint32_t& e : tree.prevEdge) {
+                if (e != INVALID_AIRPORT && e > edge) e--;
+            }
+            if (orphaned) {
+                repairIncrease(tree, to, useCost);
+            }
+        }
+        dynamicTrees[useCost].swap(trees[useCost]);
+    }
+    return true;
+}
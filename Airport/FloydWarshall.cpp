@@ -0,0 +1,131 @@
+#include "FloydWarshall.h"
+#include <algorithm>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define FW_X86 1
+#endif
+
+using namespace std;
+
+const uint32_t DistanceMatrix::BLOCK;
+
+DistanceMatrix::DistanceMatrix(uint32_t size)
+    : n(size), stride((size + BLOCK - 1) / BLOCK * BLOCK) {
+    cells.assign(static_cast<size_t>(stride) * stride, FW_INFINITY);
+    for (uint32_t i = 0; i < stride; ++i) {
+        at(i, i) = 0;
+    }
+}
+
+// c[i][j] = min(c[i][j], a[i][k] + b[k][j]) over one BLOCK x BLOCK tile. With k
+// outermost this stays correct when c aliases a or b, since the tile
+// diagonal is zero and a[i][k] / b[k][j] cannot change during step k.
+static void minPlusScalar(int32_t* c, const int32_t* a, const int32_t* b, uint32_t stride) {
+    const uint32_t BLOCK = DistanceMatrix::BLOCK;
+    for (uint32_t k = 0; k < BLOCK; ++k) {
+        const int32_t* bk = b + static_cast<size_t>(k) * stride;
+        for (uint32_t i = 0; i < BLOCK; ++i) {
+            int32_t aik = a[static_cast<size_t>(i) * stride + k];
+            int32_t* ci = c + static_cast<size_t>(i) * stride;
+            for (uint32_t j = 0; j < BLOCK; ++j) {
+                ci[j] = min(ci[j], aik + bk[j]);
+            }
+        }
+    }
+}
+
+#ifdef FW_X86
+__attribute__((target("sse4.1")))
+static void minPlusSSE41(int32_t* c, const int32_t* a, const int32_t* b, uint32_t stride) {
+    const uint32_t BLOCK = DistanceMatrix::BLOCK;
+    for (uint32_t k = 0; k < BLOCK; ++k) {
+        const int32_t* bk = b + static_cast<size_t>(k) * stride;
+        for (uint32_t i = 0; i < BLOCK; ++i) {
+            __m128i aik = _mm_set1_epi32(a[static_cast<size_t>(i) * stride + k]);
+            int32_t* ci = c + static_cast<size_t>(i) * stride;
+            for (uint32_t j = 0; j < BLOCK; j += 4) {
+                __m128i via = _mm_add_epi32(aik, _mm_loadu_si128(reinterpret_cast<const __m128i*>(bk + j)));
+                __m128i cur = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ci + j));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(ci + j), _mm_min_epi32(cur, via));
+            }
+        }
+    }
+}
+
+__attribute__((target("avx2")))
+static void minPlusAVX2(int32_t* c, const int32_t* a, const int32_t* b, uint32_t stride) {
+    const uint32_t BLOCK = DistanceMatrix::BLOCK;
+    for (uint32_t k = 0; k < BLOCK; ++k) {
+        const int32_t* bk = b + static_cast<size_t>(k) * stride;
+        for (uint32_t i = 0; i < BLOCK; ++i) {
+            __m256i aik = _mm256_set1_epi32(a[static_cast<size_t>(i) * stride + k]);
+            int32_t* ci = c + static_cast<size_t>(i) * stride;
+            for (uint32_t j = 0; j < BLOCK; j += 8) {
+                __m256i via = _mm256_add_epi32(aik, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bk + j)));
+                __m256i cur = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ci + j));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(ci + j), _mm256_min_epi32(cur, via));
+            }
+        }
+    }
+}
+#endif
+
+static MinPlusKernel selectKernel(MinPlusKernel maxKernel) {
+#ifdef FW_X86
+    if (maxKernel >= MinPlusKernel::AVX2 && __builtin_cpu_supports("avx2")) {
+        return MinPlusKernel::AVX2;
+    }
+    if (maxKernel >= MinPlusKernel::SSE41 && __builtin_cpu_supports("sse4.1")) {
+        return MinPlusKernel::SSE41;
+    }
+#else
+    (void)maxKernel;
+#endif
+    return MinPlusKernel::Scalar;
+}
+
+MinPlusKernel floydWarshall(DistanceMatrix& matrix, MinPlusKernel maxKernel) {
+    MinPlusKernel kernel = selectKernel(maxKernel);
+    void (*minPlus)(int32_t*, const int32_t*, const int32_t*, uint32_t) = minPlusScalar;
+#ifdef FW_X86
+    if (kernel == MinPlusKernel::AVX2) minPlus = minPlusAVX2;
+    else if (kernel == MinPlusKernel::SSE41) minPlus = minPlusSSE41;
+#endif
+
+    const uint32_t BLOCK = DistanceMatrix::BLOCK;
+    uint32_t stride = matrix.stride;
+    uint32_t tiles = stride / BLOCK;
+    auto tile = [&](uint32_t bi, uint32_t bj) {
+        return &matrix.cells[static_cast<size_t>(bi) * BLOCK * stride + static_cast<size_t>(bj) * BLOCK];
+    };
+
+    // Each round settles the pivot tile, then its row and column, then the rest
+    for (uint32_t kb = 0; kb < tiles; ++kb) {
+        int32_t* pivot = tile(kb, kb);
+        minPlus(pivot, pivot, pivot, stride);
+
+        for (uint32_t b = 0; b < tiles; ++b) {
+            if (b == kb) continue;
+            minPlus(tile(kb, b), pivot, tile(kb, b), stride);
+            minPlus(tile(b, kb), tile(b, kb), pivot, stride);
+        }
+
+        for (uint32_t bi = 0; bi < tiles; ++bi) {
+            if (bi == kb) continue;
+            for (uint32_t bj = 0; bj < tiles; ++bj) {
+                if (bj == kb) continue;
+                minPlus(tile(bi, bj), tile(bi, kb), tile(kb, bj), stride);
+            }
+        }
+    }
+    return kernel;
+}
+
+const char* kernelName(MinPlusKernel kernel) {
+    switch (kernel) {
+        case MinPlusKernel::AVX2: return "AVX2";
+        case MinPlusKernel::SSE41: return "SSE4.1";
+        default: return "scalar";
+    }
+}
@@ -0,0 +1,35 @@
+#ifndef FLOYDWARSHALL_H
+#define FLOYDWARSHALL_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Min-plus inner loops available to the Floyd-Warshall kernel, in order of preference
+enum class MinPlusKernel { Scalar, SSE41, AVX2 };
+
+// Marks an unreachable cell. Twice this still fits in int32_t, so a min-plus
+// step can add two cells without overflowing.
+const int32_t FW_INFINITY = INT32_MAX / 2;
+
+// Square distance matrix padded so every row is a whole number of tiles
+struct DistanceMatrix {
+    static const uint32_t BLOCK = 64;
+
+    uint32_t n;       // number of airports
+    uint32_t stride;  // padded row length, a multiple of BLOCK
+    std::vector<int32_t> cells;
+
+    DistanceMatrix(uint32_t size);
+
+    int32_t& at(uint32_t i, uint32_t j) { return cells[static_cast<std::size_t>(i) * stride + j]; }
+    int32_t at(uint32_t i, uint32_t j) const { return cells[static_cast<std::size_t>(i) * stride + j]; }
+};
+
+// Tiled Floyd-Warshall over the matrix in place. Uses the best kernel the CPU
+// supports, never above maxKernel, and returns the one it ran.
+MinPlusKernel floydWarshall(DistanceMatrix& matrix, MinPlusKernel maxKernel = MinPlusKernel::AVX2);
+
+const char* kernelName(MinPlusKernel kernel);
+
+#endif
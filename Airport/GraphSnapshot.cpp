@@ -0,0 +1,250 @@
+#include "airlineGraph.h"
+#include "MappedFile.h"
+#include <fstream>
+#include <iostream>
+#include <cstring>
+
+using namespace std;
+
+// Snapshot layout, native byte order, every section 4-byte aligned:
+//   SnapshotHeader
+//   uint32 codeOffsets[airports + 1]   into the string blob
+//   uint32 stateOffsets[states + 1]    into the string blob
+//   uint32 airportState[airports]      index into the state table
+//   uint32 csrOffsets[airports + 1]
+//   uint32 targets[edges]
+//   int32  distances[edges]
+//   int32  costs[edges]
+//   double latitudes[airports]         NaN when unknown
+//   double longitudes[airports]
+//   Timetable::Connection schedule[connections]
+//   int32  minConnection[airports]    -1 where the default applies
+//   char   strings[stringBytes]        airport codes, then state codes
+// The checksum is FNV-1a over everything after the header.
+
+static const char SNAPSHOT_MAGIC[8] = {'A', 'I', 'R', 'G', 'R', 'A', 'P', 'H'};
+static const uint32_t SNAPSHOT_VERSION = 3;
+static const uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t airports;
+    uint32_t states;
+    uint32_t edges;
+    uint32_t stringBytes;
+    uint32_t connections;
+    int32_t defaultMinConnection;
+    uint64_t checksum;
+};
+
+static uint64_t fnv1a(const char* data, size_t size, uint64_t hash = 14695981039346656037ULL) {
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static size_t payloadSize(const SnapshotHeader& header) {
+    size_t words = (static_cast<size_t>(header.airports) + 1) * 2 + header.states + 1 +
+                   header.airports * 2 + static_cast<size_t>(header.edges) * 3;
+    return words * sizeof(uint32_t) + header.airports * 2 * sizeof(double) +
+           header.connections * sizeof(Timetable::Connection) + header.stringBytes;
+}
+
+bool airlineGraph::writeSnapshot(const string& filename) {
+    ensureFrozen();
+    uint32_t n = airportCount();
+
+    // Intern state codes so each airport stores a small index
+    vector<string> states;
+    unordered_map<string, uint32_t> stateIds;
+    vector<uint32_t> airportState(n);
+    for (uint32_t id = 0; id < n; ++id) {
+        auto it = stateIds.find(airportStates[id]);
+        if (it == stateIds.end()) {
+            it = stateIds.emplace(airportStates[id], static_cast<uint32_t>(states.size())).first;
+            states.push_back(airportStates[id]);
+        }
+        airportState[id] = it->second;
+    }
+
+    string strings;
+    vector<uint32_t> codeOffsets, stateOffsets;
+    for (const auto& code : airportCodes) {
+        codeOffsets.push_back(static_cast<uint32_t>(strings.size()));
+        strings += code;
+    }
+    codeOffsets.push_back(static_cast<uint32_t>(strings.size()));
+    for (const auto& state : states) {
+        stateOffsets.push_back(static_cast<uint32_t>(strings.size()));
+        strings += state;
+    }
+    stateOffsets.push_back(static_cast<uint32_t>(strings.size()));
+
+    const vector<Timetable::Connection>& schedule = timetable.allConnections();
+    vector<int32_t> minConnection(timetable.minConnectionTimes().begin(), timetable.minConnectionTimes().end());
+    minConnection.resize(n, -1);
+
+    // Sections in file order; the header checksum covers them all
+    vector<pair<const char*, size_t>> sections = {
+        {reinterpret_cast<const char*>(codeOffsets.data()), codeOffsets.size() * sizeof(uint32_t)},
+        {reinterpret_cast<const char*>(stateOffsets.data()), stateOffsets.size() * sizeof(uint32_t)},
+        {reinterpret_cast<const char*>(airportState.data()), airportState.size() * sizeof(uint32_t)},
+        {reinterpret_cast<const char*>(csr.offsets.data()), csr.offsets.size() * sizeof(uint32_t)},
+        {reinterpret_cast<const char*>(csr.targets.data()), csr.targets.size() * sizeof(uint32_t)},
+        {reinterpret_cast<const char*>(csr.distances.data()), csr.distances.size() * sizeof(int32_t)},
+        {reinterpret_cast<const char*>(csr.costs.data()), csr.costs.size() * sizeof(int32_t)},
+        {reinterpret_cast<const char*>(airportLat.data()), airportLat.size() * sizeof(double)},
+        {reinterpret_cast<const char*>(airportLon.data()), airportLon.size() * sizeof(double)},
+        {reinterpret_cast<const char*>(schedule.data()), schedule.size() * sizeof(Timetable::Connection)},
+        {reinterpret_cast<const char*>(minConnection.data()), minConnection.size() * sizeof(int32_t)},
+        {strings.data(), strings.size()},
+    };
+
+    SnapshotHeader header;
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.byteOrder = SNAPSHOT_BYTE_ORDER;
+    header.airports = n;
+    header.states = static_cast<uint32_t>(states.size());
+    header.edges = csr.edgeCount();
+    header.stringBytes = static_cast<uint32_t>(strings.size());
+    header.connections = static_cast<uint32_t>(schedule.size());
+    header.defaultMinConnection = timetable.defaultMinConnectionTime();
+    header.checksum = 14695981039346656037ULL;
+    for (const auto& section : sections) {
+        header.checksum = fnv1a(section.first, section.second, header.checksum);
+    }
+
+    ofstream file(filename, ios::binary | ios::trunc);
+    if (!file.is_open()) {
+        cerr << "Error opening file: " << filename << endl;
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const auto& section : sections) {
+        file.write(section.first, section.second);
+    }
+    if (!file) {
+        cerr << "Error writing snapshot: " << filename << endl;
+        return false;
+    }
+    return true;
+}
+
+bool airlineGraph::loadSnapshot(const string& filename) {
+    MappedFile file;
+    if (!file.open(filename)) {
+        cerr << "Error opening file: " << filename << endl;
+        return false;
+    }
+
+    SnapshotHeader header;
+    if (file.size() < sizeof(header)) {
+        cerr << "Snapshot too short: " << filename << endl;
+        return false;
+    }
+    memcpy(&header, file.data(), sizeof(header));
+    if (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0 ||
+        header.byteOrder != SNAPSHOT_BYTE_ORDER) {
+        cerr << "Not a graph snapshot for this platform: " << filename << endl;
+        return false;
+    }
+    if (header.version != SNAPSHOT_VERSION) {
+        cerr << "Unsupported snapshot version " << header.version << ": " << filename << endl;
+        return false;
+    }
+    const char* payload = file.data() + sizeof(header);
+    size_t size = file.size() - sizeof(header);
+    if (size != payloadSize(header) || fnv1a(payload, size) != header.checksum) {
+        cerr << "Snapshot is truncated or corrupt: " << filename << endl;
+        return false;
+    }
+
+    // Bulk copies of each section; nothing is parsed or allocated per edge
+    auto take = [&payload](auto& out, size_t count) {
+        out.resize(count);
+        if (count == 0) return;  // data() may be null
+        memcpy(out.data(), payload, count * sizeof(out[0]));
+        payload += count * sizeof(out[0]);
+    };
+    uint32_t n = header.airports;
+    vector<uint32_t> codeOffsets, stateOffsets, airportState;
+    CSRGraph loaded;
+    take(codeOffsets, n + 1);
+    take(stateOffsets, static_cast<size_t>(header.states) + 1);
+    take(airportState, n);
+    take(loaded.offsets, n + 1);
+    take(loaded.targets, header.edges);
+    take(loaded.distances, header.edges);
+    take(loaded.costs, header.edges);
+    vector<double> latitudes, longitudes;
+    take(latitudes, n);
+    take(longitudes, n);
+    vector<Timetable::Connection> schedule;
+    vector<int32_t> minConnection;
+    take(schedule, header.connections);
+    take(minConnection, n);
+    const char* strings = payload;
+
+    // Offsets come from the file, so check them before trusting any lookup
+    auto ordered = [](const vector<uint32_t>& offsets, uint32_t limit) {
+        for (size_t i = 1; i < offsets.size(); ++i) {
+            if (offsets[i] < offsets[i - 1]) return false;
+        }
+        return offsets.back() <= limit;
+    };
+    bool valid = ordered(codeOffsets, header.stringBytes) && ordered(stateOffsets, header.stringBytes) &&
+                 loaded.offsets.back() == header.edges && ordered(loaded.offsets, header.edges);
+    for (size_t i = 0; valid && i < airportState.size(); ++i) valid = airportState[i] < header.states;
+    for (size_t i = 0; valid && i < loaded.targets.size(); ++i) valid = loaded.targets[i] < n;
+    for (size_t i = 0; valid && i < schedule.size(); ++i) {
+        valid = schedule[i].from < n && schedule[i].to < n && schedule[i].departure >= 0 &&
+                schedule[i].arrival > schedule[i].departure;
+    }
+    valid = valid && header.defaultMinConnection >= 0;
+    if (!valid) {
+        cerr << "Snapshot is truncated or corrupt: " << filename << endl;
+        return false;
+    }
+
+    airportCodes.assign(n, string());
+    airportStates.assign(n, string());
+    airportLat = move(latitudes);
+    airportLon = move(longitudes);
+    airportIds.clear();
+    airportIds.reserve(n);
+    for (uint32_t id = 0; id < n; ++id) {
+        airportCodes[id].assign(strings + codeOffsets[id], codeOffsets[id + 1] - codeOffsets[id]);
+        uint32_t state = airportState[id];
+        airportStates[id].assign(strings + stateOffsets[state], stateOffsets[state + 1] - stateOffsets[state]);
+        airportIds.emplace(airportCodes[id], id);
+    }
+
+    // Keep the edge list in step so later edits can re-freeze
+    flights.resize(header.edges);
+    for (uint32_t from = 0; from < n; ++from) {
+        for (uint32_t e = loaded.offsets[from]; e < loaded.offsets[from + 1]; ++e) {
+            flights[e] = Flight(from, loaded.targets[e], loaded.distances[e], loaded.costs[e]);
+        }
+    }
+    rebuildDegrees();
+
+    timetable.clear();
+    timetable.setDefaultMinConnectionTime(header.defaultMinConnection);
+    for (const auto& connection : schedule) {
+        timetable.addConnection(connection);
+    }
+    for (uint32_t id = 0; id < n; ++id) {
+        if (minConnection[id] >= 0) timetable.setMinConnectionTime(id, minConnection[id]);
+    }
+
+    csr = move(loaded);
+    csrDirty = false;
+    graphVersion++;
+    onGraphFrozen();
+    return true;
+}
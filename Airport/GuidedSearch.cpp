@@ -0,0 +1,459 @@
+#include "airlineGraph.h"
+#include <algorithm>
+#include <cmath>
+#include <queue>
+#include <set>
+
+using namespace std;
+
+// Bidirectional, A* and Contraction Hierarchy point-to-point searches and Yen's
+// k shortest routes, plus the reverse graph, great-circle calibration and ALT
+// landmarks they depend on.
+
+void airlineGraph::buildReverseGraph() {
+    uint32_t n = csr.nodeCount();
+    reverseCsr.offsets.assign(n + 1, 0);
+    for (uint32_t target : csr.targets) {
+        reverseCsr.offsets[target + 1]++;
+    }
+    for (uint32_t i = 0; i < n; ++i) {
+        reverseCsr.offsets[i + 1] += reverseCsr.offsets[i];
+    }
+
+    uint32_t m = csr.edgeCount();
+    reverseCsr.targets.resize(m);
+    reverseCsr.distances.resize(m);
+    reverseCsr.costs.resize(m);
+    reverseEdge.resize(m);
+    vector<uint32_t> cursor(reverseCsr.offsets.begin(), reverseCsr.offsets.end() - 1);
+    for (uint32_t from = 0; from < n; ++from) {
+        for (uint32_t e = csr.offsets[from]; e < csr.offsets[from + 1]; ++e) {
+            uint32_t slot = cursor[csr.targets[e]]++;
+            reverseCsr.targets[slot] = from;
+            reverseCsr.distances[slot] = csr.distances[e];
+            reverseCsr.costs[slot] = csr.costs[e];
+            reverseEdge[slot] = e;
+        }
+    }
+}
+
+double airlineGraph::greatCircleMiles(uint32_t a, uint32_t b) const {
+    const double EARTH_RADIUS_MILES = 3958.8;
+    const double RADIANS = 3.14159265358979323846 / 180.0;
+    double dLat = (airportLat[b] - airportLat[a]) * RADIANS;
+    double dLon = (airportLon[b] - airportLon[a]) * RADIANS;
+    double h = sin(dLat / 2) * sin(dLat / 2) +
+               cos(airportLat[a] * RADIANS) * cos(airportLat[b] * RADIANS) * sin(dLon / 2) * sin(dLon / 2);
+    return 2 * EARTH_RADIUS_MILES * asin(min(1.0, sqrt(h)));
+}
+
+void airlineGraph::calibrateGeoBound() {
+    uint32_t n = airportCount();
+    allLocated = n > 0;
+    for (uint32_t id = 0; id < n && allLocated; ++id) {
+        allLocated = !std::isnan(airportLat[id]) && !std::isnan(airportLon[id]);
+    }
+    if (!allLocated) return;
+
+    // Scale great-circle miles so no flight is shorter than its bound. The triangle
+    // inequality then makes scaled distance to the target a consistent heuristic,
+    // whatever unit or rounding the Distance column uses.
+    geoScale = 1.0;
+    for (uint32_t from = 0; from < n; ++from) {
+        for (uint32_t e = csr.offsets[from]; e < csr.offsets[from + 1]; ++e) {
+            double miles = greatCircleMiles(from, csr.targets[e]);
+            if (miles > 0) {
+                geoScale = min(geoScale, csr.distances[e] / miles);
+            }
+        }
+    }
+    geoScale *= 1 - 1e-9;  // absorb floating-point error in the bound
+}
+
+static void fullDijkstra(const CSRGraph& graph, const vector<int>& weights, uint32_t src, StampedArray<int>& dist,
+                         MinHeapBuffer& pq) {
+    dist.reset(graph.nodeCount(), UNREACHED);
+    pq.clear();
+    dist.at(src) = 0;
+    pq.push({0, src});
+    while (!pq.empty()) {
+        int curDist = pq.top().first;
+        uint32_t cur = pq.top().second;
+        pq.pop();
+        if (curDist > dist[cur]) continue;
+        for (uint32_t e = graph.offsets[cur]; e < graph.offsets[cur + 1]; ++e) {
+            uint32_t next = graph.targets[e];
+            if (curDist + weights[e] < dist[next]) {
+                dist.at(next) = curDist + weights[e];
+                pq.push({dist[next], next});
+            }
+        }
+    }
+}
+
+void airlineGraph::buildLandmarks(unsigned count) {
+    ensureFrozen();
+    uint32_t n = csr.nodeCount();
+    landmarkTable = LandmarkTable();
+    count = min<unsigned>(count, n);
+    if (count == 0) return;
+
+    // Farthest-point selection: start at the busiest airport, then repeatedly
+    // take the airport farthest (by distance, either direction) from every
+    // landmark so far. Airports no landmark touches are taken first, so each
+    // component gets covered.
+    uint32_t next = 0;
+    for (uint32_t v = 1; v < n; ++v) {
+        if (inDegree[v] + outDegree[v] > inDegree[next] + outDegree[next]) next = v;
+    }
+    vector<int> closest(n, UNREACHED);
+    vector<vector<int>> from[2], to[2];
+    SearchWorkspace& workspace = SearchWorkspace::local();
+    StampedArray<int>& dist = workspace.bound;
+    auto dense = [n, &dist]() {
+        vector<int> row(n);
+        for (uint32_t v = 0; v < n; ++v) row[v] = dist[v];
+        return row;
+    };
+    for (unsigned i = 0; i < count; ++i) {
+        uint32_t landmark = next;
+        landmarkTable.landmarks.push_back(landmark);
+        for (int useCost = 0; useCost < 2; ++useCost) {
+            fullDijkstra(csr, useCost ? csr.costs : csr.distances, landmark, dist, workspace.heap[0]);
+            from[useCost].push_back(dense());
+            fullDijkstra(reverseCsr, useCost ? reverseCsr.costs : reverseCsr.distances, landmark, dist,
+                         workspace.heap[0]);
+            to[useCost].push_back(dense());
+        }
+        closest[landmark] = 0;
+
+        int farthest = -1;
+        bool foundUntouched = false;
+        for (uint32_t v = 0; v < n; ++v) {
+            int d = min(from[0].back()[v], to[0].back()[v]);
+            closest[v] = min(closest[v], d);
+            if (foundUntouched) continue;
+            if (closest[v] == UNREACHED) {
+                next = v;
+                foundUntouched = true;
+            } else if (closest[v] > farthest) {
+                farthest = closest[v];
+                next = v;
+            }
+        }
+        if (!foundUntouched && farthest <= 0) break;  // every airport is already a landmark
+    }
+
+    uint32_t L = static_cast<uint32_t>(landmarkTable.landmarks.size());
+    for (int useCost = 0; useCost < 2; ++useCost) {
+        landmarkTable.fromLandmark[useCost].resize(static_cast<size_t>(n) * L);
+        landmarkTable.toLandmark[useCost].resize(static_cast<size_t>(n) * L);
+        for (uint32_t v = 0; v < n; ++v) {
+            for (uint32_t l = 0; l < L; ++l) {
+                landmarkTable.fromLandmark[useCost][static_cast<size_t>(v) * L + l] = from[useCost][l][v];
+                landmarkTable.toLandmark[useCost][static_cast<size_t>(v) * L + l] = to[useCost][l][v];
+            }
+        }
+    }
+}
+
+Path airlineGraph::aStarPath(uint32_t src, uint32_t target, bool useCost) const {
+    uint32_t n = csr.nodeCount();
+    const vector<int>& weights = useCost ? csr.costs : csr.distances;
+    bool geometric = !useCost && allLocated;
+    uint32_t L = static_cast<uint32_t>(landmarkTable.landmarks.size());
+    const int* fromT = L ? &landmarkTable.fromLandmark[useCost][static_cast<size_t>(target) * L] : nullptr;
+    const int* toT = L ? &landmarkTable.toLandmark[useCost][static_cast<size_t>(target) * L] : nullptr;
+
+    // Largest of the applicable lower bounds on the remaining weight to target.
+    // Landmark terms are skipped where either side is unreachable, which keeps
+    // the bound admissible though not always consistent, so nodes may reopen.
+    SearchWorkspace& workspace = SearchWorkspace::local();
+    StampedArray<int>& bound = workspace.bound;
+    StampedArray<SearchLabel>& labels = workspace.labels[0];
+    MinHeapBuffer& pq = workspace.heap[0];
+    bound.reset(n, -1);
+    labels.reset(n, {UNREACHED, INVALID_AIRPORT});
+    pq.clear();
+
+    auto heuristic = [&](uint32_t v) {
+        if (bound[v] >= 0) return bound[v];
+        double best = 0;
+        if (geometric) {
+            best = geoScale * greatCircleMiles(v, target);
+        }
+        if (L) {
+            const int* fromV = &landmarkTable.fromLandmark[useCost][static_cast<size_t>(v) * L];
+            const int* toV = &landmarkTable.toLandmark[useCost][static_cast<size_t>(v) * L];
+            for (uint32_t l = 0; l < L; ++l) {
+                if (fromV[l] != UNREACHED && fromT[l] != UNREACHED) best = max(best, double(fromT[l] - fromV[l]));
+                if (toV[l] != UNREACHED && toT[l] != UNREACHED) best = max(best, double(toV[l] - toT[l]));
+            }
+        }
+        bound.at(v) = static_cast<int>(floor(best));
+        return bound[v];
+    };
+
+    labels.at(src).dist = 0;
+    pq.push({heuristic(src), src});
+
+    while (!pq.empty()) {
+        int estimate = pq.top().first;
+        uint32_t cur = pq.top().second;
+        pq.pop();
+
+        int curDist = labels[cur].dist;
+        if (estimate > curDist + heuristic(cur)) continue;
+        if (cur == target) break;
+
+        for (uint32_t e = csr.offsets[cur]; e < csr.offsets[cur + 1]; ++e) {
+            uint32_t next = csr.targets[e];
+            if (curDist + weights[e] < labels[next].dist) {
+                labels.at(next) = {curDist + weights[e], e};
+                pq.push({curDist + weights[e] + heuristic(next), next});
+            }
+        }
+    }
+
+    if (labels[target].dist == UNREACHED) {
+        return Path();
+    }
+    return buildPath(src, target, labels);
+}
+
+Path airlineGraph::bidirectionalPath(uint32_t src, uint32_t target, const RouteMetric& metric) const {
+    SearchWorkspace& workspace = SearchWorkspace::local();
+    return withWeightPolicy(metric, csr.distances, csr.costs, [&](auto weight) {
+        int maxStep = weight.maxStep(maxWeight[0], maxWeight[1]);
+        return workspace.withQueues(bidirectionalQueue, maxStep, [&](auto& pqF, auto& pqB) {
+            return bidirectionalSearch(src, target, weight, pqF, pqB);
+        });
+    });
+}
+
+template <class Weight, class Queue>
+Path airlineGraph::bidirectionalSearch(uint32_t src, uint32_t target, Weight weight, Queue& pqF, Queue& pqB) const {
+    uint32_t n = csr.nodeCount();
+
+    // Forward search from src over csr, backward search from target over reverseCsr.
+    // A backward label's via is the forward flight that leaves v on the backward tree.
+    SearchWorkspace& workspace = SearchWorkspace::local();
+    StampedArray<SearchLabel>& labelsF = workspace.labels[0];
+    StampedArray<SearchLabel>& labelsB = workspace.labels[1];
+    labelsF.reset(n, {UNREACHED, INVALID_AIRPORT});
+    labelsB.reset(n, {UNREACHED, INVALID_AIRPORT});
+    labelsF.at(src).dist = 0;
+    labelsB.at(target).dist = 0;
+    pqF.push({0, src});
+    pqB.push({0, target});
+
+    int best = (src == target) ? 0 : UNREACHED;
+    uint32_t meet = (src == target) ? src : INVALID_AIRPORT;
+
+    // Once the two frontiers together reach the best meeting weight, no shorter
+    // route can still be found
+    while (!pqF.empty() && !pqB.empty() &&
+           static_cast<long long>(pqF.top().first) + pqB.top().first < best) {
+        bool forward = pqF.top().first <= pqB.top().first;
+        Queue& pq = forward ? pqF : pqB;
+        StampedArray<SearchLabel>& labels = forward ? labelsF : labelsB;
+        const StampedArray<SearchLabel>& other = forward ? labelsB : labelsF;
+        const CSRGraph& graph = forward ? csr : reverseCsr;
+
+        int curDist = pq.top().first;
+        uint32_t cur = pq.top().second;
+        pq.pop();
+        if (curDist > labels[cur].dist) continue;
+
+        for (uint32_t i = graph.offsets[cur]; i < graph.offsets[cur + 1]; ++i) {
+            uint32_t next = graph.targets[i];
+            uint32_t e = forward ? i : reverseEdge[i];
+            int nd = curDist + weight(e);
+            if (nd < labels[next].dist) {
+                labels.at(next) = {nd, e};
+                pq.push({nd, next});
+            }
+            int dist = labels[next].dist;
+            int otherDist = other[next].dist;
+            if (otherDist != UNREACHED && static_cast<long long>(dist) + otherDist < best) {
+                best = dist + otherDist;
+                meet = next;
+            }
+        }
+    }
+
+    if (meet == INVALID_AIRPORT) {
+        return Path();
+    }
+    vector<uint32_t> edges;
+    for (uint32_t at = meet; at != src; at = csr.edgeSource(edges.back())) {
+        edges.push_back(labelsF[at].via);
+    }
+    reverse(edges.begin(), edges.end());
+    for (uint32_t at = meet; at != target; at = csr.targets[edges.back()]) {
+        edges.push_back(labelsB[at].via);
+    }
+    return edgePath(src, edges);
+}
+
+void airlineGraph::buildContractionHierarchy(bool useCost) {
+    ensureFrozen();
+    hierarchies[useCost].build(csr, useCost ? csr.costs : csr.distances);
+}
+
+Path airlineGraph::hierarchyPath(uint32_t src, uint32_t target, bool useCost) const {
+    vector<uint32_t> edges;
+    if (hierarchies[useCost].query(src, target, edges, SearchWorkspace::local()) < 0) {
+        return Path();
+    }
+    return edgePath(src, edges);
+}
+
+namespace {
+
+// A* over the frozen CSR for Yen's spur searches. Banned flights and airports
+// are flagged in masks rather than removed, and the exact unmasked distances
+// to the destination stay a consistent heuristic whatever the masks hide.
+// Labels, heap and masks come from the thread's workspace, so each spur
+// starts in O(1).
+struct SpurSearch {
+    const CSRGraph& graph;
+    const vector<int>& weights;
+    const StampedArray<int>& toTarget;
+    StampedArray<SearchLabel>& labels;
+    MinHeapBuffer& pq;
+    StampedArray<uint8_t>& edgeBanned;
+    StampedArray<uint8_t>& nodeBanned;
+
+    SpurSearch(const CSRGraph& g, const vector<int>& w, const StampedArray<int>& h, SearchWorkspace& workspace)
+        : graph(g), weights(w), toTarget(h), labels(workspace.labels[0]), pq(workspace.heap[0]),
+          edgeBanned(workspace.flightFlags), nodeBanned(workspace.airportFlags) {
+        edgeBanned.reset(g.edgeCount(), 0);
+        nodeBanned.reset(g.nodeCount(), 0);
+    }
+
+    // Appends a shortest unbanned src -> target route to edges and returns its
+    // weight, or returns UNREACHED and leaves edges alone
+    int run(uint32_t src, uint32_t target, vector<uint32_t>& edges) {
+        if (toTarget[src] == UNREACHED) return UNREACHED;
+        labels.reset(graph.nodeCount(), {UNREACHED, INVALID_AIRPORT});
+        pq.clear();
+        labels.at(src).dist = 0;
+        pq.push({toTarget[src], src});
+
+        while (!pq.empty()) {
+            int estimate = pq.top().first;
+            uint32_t cur = pq.top().second;
+            pq.pop();
+
+            int curDist = labels[cur].dist;
+            if (estimate > curDist + toTarget[cur]) continue;
+            if (cur == target) break;
+
+            for (uint32_t e = graph.offsets[cur]; e < graph.offsets[cur + 1]; ++e) {
+                uint32_t next = graph.targets[e];
+                if (edgeBanned[e] || nodeBanned[next] || toTarget[next] == UNREACHED) continue;
+                if (curDist + weights[e] < labels[next].dist) {
+                    labels.at(next) = {curDist + weights[e], e};
+                    pq.push({curDist + weights[e] + toTarget[next], next});
+                }
+            }
+        }
+
+        if (labels[target].dist == UNREACHED) return UNREACHED;
+        size_t first = edges.size();
+        for (uint32_t at = target; at != src; at = graph.edgeSource(labels[at].via)) {
+            edges.push_back(labels[at].via);
+        }
+        reverse(edges.begin() + first, edges.end());
+        return labels[target].dist;
+    }
+};
+
+}
+
+vector<Path> airlineGraph::kShortestPaths(const string& origin, const string& dest, size_t k, bool useCost) {
+    vector<Path> paths;
+    uint32_t src = getIndex(origin);
+    uint32_t target = getIndex(dest);
+    if (src == INVALID_AIRPORT || target == INVALID_AIRPORT || k == 0) {
+        return paths;
+    }
+    ensureFrozen();
+    if (!mayReach(src, target)) {
+        return paths;
+    }
+
+    const vector<int>& weights = useCost ? csr.costs : csr.distances;
+    // Exact distances to dest, kept in the workspace's heuristic slot
+    SearchWorkspace& workspace = SearchWorkspace::local();
+    fullDijkstra(reverseCsr, useCost ? reverseCsr.costs : reverseCsr.distances, target, workspace.bound,
+                 workspace.heap[0]);
+    SpurSearch search(csr, weights, workspace.bound, workspace);
+
+    struct Route {
+        int weight;
+        vector<uint32_t> edges;
+    };
+    vector<Route> accepted(1);
+    accepted[0].weight = search.run(src, target, accepted[0].edges);
+    if (accepted[0].weight == UNREACHED) {
+        return paths;
+    }
+
+    // Candidate routes by weight, then fewest flights; seen holds every route
+    // ever generated so a spur rediscovering one is dropped
+    vector<Route> candidates;
+    auto worse = [&candidates](uint32_t a, uint32_t b) {
+        if (candidates[a].weight != candidates[b].weight) return candidates[a].weight > candidates[b].weight;
+        return candidates[a].edges.size() > candidates[b].edges.size();
+    };
+    priority_queue<uint32_t, vector<uint32_t>, decltype(worse)> pending(worse);
+    set<vector<uint32_t>> seen = {accepted[0].edges};
+    vector<uint32_t> banned;
+
+    while (accepted.size() < k) {
+        const vector<uint32_t>& last = accepted.back().edges;
+        uint32_t spur = src;
+        int rootWeight = 0;
+
+        for (size_t i = 0; i < last.size(); ++i) {
+            // Leave the root by a flight no accepted route with this root has taken
+            for (const Route& route : accepted) {
+                if (route.edges.size() > i && equal(last.begin(), last.begin() + i, route.edges.begin())) {
+                    search.edgeBanned.at(route.edges[i]) = 1;
+                    banned.push_back(route.edges[i]);
+                }
+            }
+
+            vector<uint32_t> edges(last.begin(), last.begin() + i);
+            int spurWeight = search.run(spur, target, edges);
+            if (spurWeight != UNREACHED && seen.insert(edges).second) {
+                candidates.push_back({rootWeight + spurWeight, move(edges)});
+                pending.push(static_cast<uint32_t>(candidates.size() - 1));
+            }
+
+            for (uint32_t e : banned) {
+                search.edgeBanned.at(e) = 0;
+            }
+            banned.clear();
+            // Root airports stay off limits so every route is loopless
+            search.nodeBanned.at(spur) = 1;
+            rootWeight += weights[last[i]];
+            spur = csr.targets[last[i]];
+        }
+
+        search.nodeBanned.at(src) = 0;
+        for (uint32_t e : last) {
+            search.nodeBanned.at(csr.targets[e]) = 0;
+        }
+        if (pending.empty()) break;
+        accepted.push_back(move(candidates[pending.top()]));
+        pending.pop();
+    }
+
+    for (const Route& route : accepted) {
+        paths.push_back(edgePath(src, route.edges));
+    }
+    return paths;
+}
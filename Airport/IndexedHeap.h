@@ -0,0 +1,97 @@
+#ifndef INDEXEDHEAP_H
+#define INDEXEDHEAP_H
+
+#include <vector>
+#include <cstdint>
+#include <utility>
+
+// Min-heap of dense ids with integer keys and a D-way branching factor. The
+// position of every queued id is tracked, so decreaseKey is O(log_D n) and an
+// id is never queued twice.
+template <unsigned D = 4>
+class IndexedHeap {
+    static const uint32_t NOT_QUEUED = UINT32_MAX;
+
+    std::vector<uint32_t> heap;      // ids in heap order
+    std::vector<int> keys;           // key per id
+    std::vector<uint32_t> position;  // slot in heap per id, or NOT_QUEUED
+
+    void place(uint32_t slot, uint32_t id) {
+        heap[slot] = id;
+        position[id] = slot;
+    }
+
+    void siftUp(uint32_t slot) {
+        uint32_t id = heap[slot];
+        while (slot > 0) {
+            uint32_t parent = (slot - 1) / D;
+            if (keys[heap[parent]] <= keys[id]) break;
+            place(slot, heap[parent]);
+            slot = parent;
+        }
+        place(slot, id);
+    }
+
+    void siftDown(uint32_t slot) {
+        uint32_t id = heap[slot];
+        uint32_t size = static_cast<uint32_t>(heap.size());
+        while (true) {
+            uint32_t first = slot * D + 1;
+            if (first >= size) break;
+            uint32_t best = first;
+            uint32_t last = first + D < size ? first + D : size;
+            for (uint32_t child = first + 1; child < last; ++child) {
+                if (keys[heap[child]] < keys[heap[best]]) best = child;
+            }
+            if (keys[heap[best]] >= keys[id]) break;
+            place(slot, heap[best]);
+            slot = best;
+        }
+        place(slot, id);
+    }
+
+public:
+    explicit IndexedHeap(uint32_t capacity = 0) : keys(capacity), position(capacity, NOT_QUEUED) {}
+
+    // Empties the heap and makes room for ids below capacity
+    void reset(uint32_t capacity) {
+        heap.clear();
+        keys.assign(capacity, 0);
+        position.assign(capacity, NOT_QUEUED);
+    }
+
+    bool empty() const { return heap.empty(); }
+    bool contains(uint32_t id) const { return position[id] != NOT_QUEUED; }
+    int key(uint32_t id) const { return keys[id]; }
+
+    // Queues id, or lowers its key if it is already queued with a larger one
+    void pushOrDecrease(uint32_t id, int key) {
+        if (contains(id)) {
+            if (key >= keys[id]) return;
+            keys[id] = key;
+            siftUp(position[id]);
+            return;
+        }
+        keys[id] = key;
+        heap.push_back(id);
+        siftUp(static_cast<uint32_t>(heap.size() - 1));
+    }
+
+    // Removes and returns the (key, id) with the smallest key
+    std::pair<int, uint32_t> pop() {
+        uint32_t top = heap.front();
+        position[top] = NOT_QUEUED;
+        uint32_t last = heap.back();
+        heap.pop_back();
+        if (!heap.empty()) {
+            heap[0] = last;
+            siftDown(0);
+        }
+        return {keys[top], top};
+    }
+};
+
+template <unsigned D>
+const uint32_t IndexedHeap<D>::NOT_QUEUED;
+
+#endif
@@ -0,0 +1,92 @@
+#include "airlineGraph.h"
+#include <iostream>
+
+using namespace std;
+
+bool airlineGraph::addScheduledFlight(const string& origin, const string& dest, int departure, int arrival,
+                                      int dist, int cost) {
+    if (departure < 0 || arrival <= departure) {
+        cerr << "Invalid flight times " << departure << " -> " << arrival << " for " << origin << " -> " << dest << endl;
+        return false;
+    }
+    appendScheduledFlight(internAirport(origin), internAirport(dest), departure, arrival, dist, cost);
+    return true;
+}
+
+void airlineGraph::appendScheduledFlight(uint32_t from, uint32_t to, int departure, int arrival, int dist, int cost) {
+    appendFlight(from, to, dist, cost);
+    timetable.addConnection(Timetable::Connection{from, to, departure, arrival, dist, cost});
+}
+
+bool airlineGraph::setMinConnectionTime(const string& air_code, int minutes) {
+    uint32_t id = getIndex(air_code);
+    if (id == INVALID_AIRPORT || minutes < 0) {
+        cerr << "Invalid minimum connection time " << minutes << " for " << air_code << endl;
+        return false;
+    }
+    timetable.setMinConnectionTime(id, minutes);
+    graphVersion++;
+    return true;
+}
+
+bool airlineGraph::setDefaultMinConnectionTime(int minutes) {
+    if (minutes < 0) {
+        cerr << "Invalid minimum connection time " << minutes << endl;
+        return false;
+    }
+    timetable.setDefaultMinConnectionTime(minutes);
+    graphVersion++;
+    return true;
+}
+
+Journey airlineGraph::buildJourney(uint32_t origin, const vector<uint32_t>& connections) const {
+    Journey journey;
+    journey.route.air_code.push_back(airportCodes[origin]);
+    for (uint32_t index : connections) {
+        const Timetable::Connection& c = timetable.connection(index);
+        journey.route.air_code.push_back(airportCodes[c.to]);
+        journey.route.totalDistance += c.distance;
+        journey.route.totalCost += c.cost;
+        journey.departures.push_back(c.departure);
+        journey.arrivals.push_back(c.arrival);
+    }
+    return journey;
+}
+
+Journey airlineGraph::earliestArrival(const string& origin, const string& dest, int departAfter) {
+    uint32_t src = getIndex(origin);
+    uint32_t target = getIndex(dest);
+    if (src == INVALID_AIRPORT || target == INVALID_AIRPORT) {
+        return Journey();
+    }
+    if (src == target) {
+        return buildJourney(src, {});
+    }
+    if (!timetable.sorted()) {
+        timetable.sort();
+    }
+    vector<uint32_t> legs;
+    if (timetable.earliestArrival(src, target, departAfter, legs, SearchWorkspace::local()) < 0) {
+        return Journey();
+    }
+    return buildJourney(src, legs);
+}
+
+vector<Journey> airlineGraph::arrivalProfile(const string& origin, const string& dest, int from, int until) {
+    uint32_t src = getIndex(origin);
+    uint32_t target = getIndex(dest);
+    if (src == INVALID_AIRPORT || target == INVALID_AIRPORT) {
+        return {};
+    }
+    if (!timetable.sorted()) {
+        timetable.sort();
+    }
+    vector<vector<uint32_t>> options;
+    timetable.profile(src, target, from, until, options);
+    vector<Journey> journeys;
+    journeys.reserve(options.size());
+    for (const auto& legs : options) {
+        journeys.push_back(buildJourney(src, legs));
+    }
+    return journeys;
+}
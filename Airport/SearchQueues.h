@@ -0,0 +1,145 @@
+#ifndef SEARCHQUEUES_H
+#define SEARCHQUEUES_H
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <queue>
+
+// Priority queues for label-setting searches over (key, id) pairs. All three
+// share one interface and keep their buffers between searches. The radix heap
+// and Dial buckets rely on Dijkstra's monotone keys: nothing is pushed below
+// the last key popped, and Dial additionally needs every push to be at most
+// maxStep above it.
+enum class QueueKind { BinaryHeap, Radix, Dial };
+
+// Dial is only used while its ring stays this small; larger steps use Radix
+const int DIAL_MAX_BUCKETS = 1 << 16;
+
+// Plain min-queue for searches that run outside a SearchWorkspace
+typedef std::priority_queue<std::pair<int, uint32_t>, std::vector<std::pair<int, uint32_t>>,
+                            std::greater<std::pair<int, uint32_t>>> MinQueue;
+
+class MinHeapBuffer {
+    std::vector<std::pair<int, uint32_t>> items;
+
+public:
+    void reset(int) { items.clear(); }
+    void clear() { items.clear(); }
+    bool empty() const { return items.empty(); }
+    const std::pair<int, uint32_t>& top() const { return items.front(); }
+
+    void push(const std::pair<int, uint32_t>& item) {
+        items.push_back(item);
+        std::push_heap(items.begin(), items.end(), std::greater<std::pair<int, uint32_t>>());
+    }
+
+    void pop() {
+        std::pop_heap(items.begin(), items.end(), std::greater<std::pair<int, uint32_t>>());
+        items.pop_back();
+    }
+};
+
+// Monotone radix heap: bucket b holds keys whose highest bit differing from
+// the last minimum is bit b - 1, so each item moves down at most 32 times.
+class RadixHeapBuffer {
+    std::vector<std::pair<int, uint32_t>> buckets[33];
+    uint32_t last = 0;
+    size_t count = 0;
+
+    static unsigned bucketOf(uint32_t key, uint32_t base) {
+        uint32_t diff = key ^ base;
+        if (diff == 0) return 0;
+#if defined(__GNUC__)
+        return 32 - __builtin_clz(diff);
+#else
+        unsigned bits = 0;
+        for (; diff; diff >>= 1) ++bits;
+        return bits;
+#endif
+    }
+
+public:
+    void reset(int) {
+        for (auto& bucket : buckets) bucket.clear();
+        last = 0;
+        count = 0;
+    }
+    bool empty() const { return count == 0; }
+
+    void push(const std::pair<int, uint32_t>& item) {
+        buckets[bucketOf(static_cast<uint32_t>(item.first), last)].push_back(item);
+        ++count;
+    }
+
+    // Refills bucket 0 from the lowest non-empty bucket when it runs dry
+    const std::pair<int, uint32_t>& top() {
+        if (buckets[0].empty()) {
+            unsigned b = 1;
+            while (buckets[b].empty()) ++b;
+            uint32_t minimum = UINT32_MAX;
+            for (const auto& item : buckets[b]) {
+                minimum = std::min(minimum, static_cast<uint32_t>(item.first));
+            }
+            last = minimum;
+            for (const auto& item : buckets[b]) {
+                buckets[bucketOf(static_cast<uint32_t>(item.first), last)].push_back(item);
+            }
+            buckets[b].clear();
+        }
+        return buckets[0].back();
+    }
+
+    void pop() {
+        top();
+        buckets[0].pop_back();
+        --count;
+    }
+};
+
+// Dial's bucket queue: a ring of maxStep + 1 (rounded up to a power of two)
+// id lists indexed by key, swept forward from the current minimum
+class DialBuffer {
+    std::vector<std::vector<uint32_t>> buckets;
+    std::vector<uint32_t> used;  // buckets that may hold leftovers from the last search
+    uint32_t mask = 0;
+    int current = 0;
+    size_t count = 0;
+    std::pair<int, uint32_t> front;
+
+public:
+    void reset(int maxStep) {
+        for (uint32_t b : used) buckets[b].clear();
+        used.clear();
+        size_t size = 1;
+        while (size < static_cast<size_t>(maxStep) + 1) size <<= 1;
+        if (buckets.size() < size) buckets.resize(size);
+        mask = static_cast<uint32_t>(size - 1);
+        current = 0;
+        count = 0;
+    }
+    bool empty() const { return count == 0; }
+
+    void push(const std::pair<int, uint32_t>& item) {
+        std::vector<uint32_t>& bucket = buckets[static_cast<uint32_t>(item.first) & mask];
+        if (bucket.empty()) used.push_back(static_cast<uint32_t>(item.first) & mask);
+        bucket.push_back(item.second);
+        ++count;
+    }
+
+    const std::pair<int, uint32_t>& top() {
+        while (buckets[static_cast<uint32_t>(current) & mask].empty()) ++current;
+        front = {current, buckets[static_cast<uint32_t>(current) & mask].back()};
+        return front;
+    }
+
+    void pop() {
+        top();
+        buckets[static_cast<uint32_t>(current) & mask].pop_back();
+        --count;
+    }
+};
+
+#endif
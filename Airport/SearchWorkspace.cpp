@@ -0,0 +1,6 @@
+#include "SearchWorkspace.h"
+
+SearchWorkspace& SearchWorkspace::local() {
+    static thread_local SearchWorkspace workspace;
+    return workspace;
+}
@@ -0,0 +1,103 @@
+#ifndef SEARCHWORKSPACE_H
+#define SEARCHWORKSPACE_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <limits>
+#include "SearchQueues.h"
+
+// Per-airport array whose entries read as a fallback value until written in
+// the current generation. reset() is O(1) unless the array has to grow or the
+// generation counter wraps, so a search only pays for the airports it touches.
+template <class T>
+class StampedArray {
+    std::vector<T> values;
+    std::vector<uint32_t> stamps;
+    uint32_t generation = 0;
+    T fallback = T();
+
+public:
+    void reset(size_t size, const T& value) {
+        fallback = value;
+        if (stamps.size() < size) {
+            values.resize(size);
+            stamps.resize(size, 0);
+        }
+        if (++generation == 0) {
+            std::fill(stamps.begin(), stamps.end(), 0);
+            generation = 1;
+        }
+    }
+
+    const T& operator[](size_t i) const {
+        return stamps[i] == generation ? values[i] : fallback;
+    }
+
+    // Writable entry, holding the fallback if untouched this generation
+    T& at(size_t i) {
+        if (stamps[i] != generation) {
+            stamps[i] = generation;
+            values[i] = fallback;
+        }
+        return values[i];
+    }
+};
+
+// Tentative weight of an airport no search has reached yet
+const int UNREACHED = std::numeric_limits<int>::max();
+
+// Tentative weight of an airport and the edge or arc that set it
+struct SearchLabel {
+    int dist;
+    uint32_t via;
+};
+
+// Scratch space that point-to-point searches borrow instead of allocating.
+// Each thread owns one through local(); an engine resets the parts it uses on
+// entry and must not call another engine while it holds them.
+class SearchWorkspace {
+public:
+    StampedArray<SearchLabel> labels[2];  // forward and backward search
+    StampedArray<int> bound;              // memoised A* heuristic
+    StampedArray<uint32_t> tally;         // per-airport counts, e.g. labels settled
+    StampedArray<uint8_t> airportFlags;   // targets or banned airports
+    StampedArray<uint8_t> flightFlags;    // banned flights, by csr edge id
+    MinHeapBuffer heap[2];
+    RadixHeapBuffer radix[2];
+    DialBuffer dial[2];
+    std::vector<uint32_t> frontier[2];
+
+    // Stop-limited search: the rounds in which each airport improved, newest
+    // first, chained through a shared log
+    struct Improvement {
+        uint32_t round, edge, next;
+    };
+    StampedArray<uint32_t> lastImprovement;
+    StampedArray<uint32_t> queuedRound;
+    std::vector<Improvement> improvements;
+
+    static SearchWorkspace& local();
+
+    // Calls visit with this workspace's forward and backward queues of the
+    // given kind, emptied for keys that grow by at most maxStep per push
+    template <class Visitor>
+    auto withQueues(QueueKind kind, int maxStep, Visitor&& visit) -> decltype(visit(heap[0], heap[1])) {
+        if (kind == QueueKind::Dial && maxStep < DIAL_MAX_BUCKETS) {
+            dial[0].reset(maxStep);
+            dial[1].reset(maxStep);
+            return visit(dial[0], dial[1]);
+        }
+        if (kind != QueueKind::BinaryHeap) {
+            radix[0].reset(maxStep);
+            radix[1].reset(maxStep);
+            return visit(radix[0], radix[1]);
+        }
+        heap[0].reset(maxStep);
+        heap[1].reset(maxStep);
+        return visit(heap[0], heap[1]);
+    }
+};
+
+#endif
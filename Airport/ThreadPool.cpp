@@ -0,0 +1,83 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+using namespace std;
+
+ThreadPool::ThreadPool(unsigned threads) : queued(0), pending(0), nextQueue(0), stopping(false) {
+    if (threads == 0) {
+        threads = max(1u, thread::hardware_concurrency());
+    }
+    for (unsigned i = 0; i < threads; ++i) {
+        queues.emplace_back(new WorkQueue());
+    }
+    for (unsigned i = 0; i < threads; ++i) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard<mutex> guard(stateLock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(function<void()> task) {
+    WorkQueue& queue = *queues[nextQueue++ % queues.size()];
+    {
+        lock_guard<mutex> guard(queue.lock);
+        queue.tasks.push_back(move(task));
+    }
+    {
+        // Counted under stateLock so a worker checking for work cannot miss it
+        lock_guard<mutex> guard(stateLock);
+        queued++;
+        pending++;
+    }
+    wake.notify_one();
+}
+
+void ThreadPool::wait() {
+    unique_lock<mutex> guard(stateLock);
+    idle.wait(guard, [this] { return pending == 0; });
+}
+
+bool ThreadPool::tryRunTask(unsigned self) {
+    function<void()> task;
+    for (size_t i = 0; i < queues.size() && !task; ++i) {
+        WorkQueue& queue = *queues[(self + i) % queues.size()];
+        lock_guard<mutex> guard(queue.lock);
+        if (queue.tasks.empty()) continue;
+        if (i == 0) {
+            task = move(queue.tasks.back());
+            queue.tasks.pop_back();
+        } else {
+            task = move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+    }
+    if (!task) {
+        return false;
+    }
+
+    queued--;
+    task();
+    if (--pending == 0) {
+        lock_guard<mutex> guard(stateLock);
+        idle.notify_all();
+    }
+    return true;
+}
+
+void ThreadPool::workerLoop(unsigned self) {
+    while (true) {
+        if (tryRunTask(self)) continue;
+        unique_lock<mutex> guard(stateLock);
+        wake.wait(guard, [this] { return stopping || queued > 0; });
+        if (stopping && queued == 0) return;
+    }
+}
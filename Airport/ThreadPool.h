@@ -0,0 +1,45 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+// Fixed set of workers, each with its own task deque. A worker runs its own
+// newest task first and, when empty, steals the oldest task from a sibling.
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned threads = 0);  // 0 uses every core
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(std::function<void()> task);
+    void wait();  // blocks until every submitted task has finished
+    unsigned size() const { return static_cast<unsigned>(workers.size()); }
+
+private:
+    struct WorkQueue {
+        std::mutex lock;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> workers;
+    std::mutex stateLock;
+    std::condition_variable wake, idle;
+    std::atomic<size_t> queued, pending;
+    std::atomic<unsigned> nextQueue;
+    bool stopping;
+
+    bool tryRunTask(unsigned self);
+    void workerLoop(unsigned self);
+};
+
+#endif
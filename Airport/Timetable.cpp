@@ -0,0 +1,148 @@
+#include "Timetable.h"
+#include <algorithm>
+
+using namespace std;
+
+void Timetable::clear() {
+    connections.clear();
+    minConnection.clear();
+    ordered = true;
+}
+
+void Timetable::track(uint32_t airport) {
+    if (airport >= minConnection.size()) {
+        minConnection.resize(static_cast<size_t>(airport) + 1, -1);
+    }
+}
+
+void Timetable::addConnection(const Connection& connection) {
+    track(connection.from);
+    track(connection.to);
+    ordered = ordered && (connections.empty() || connections.back().departure <= connection.departure);
+    connections.push_back(connection);
+}
+
+void Timetable::setMinConnectionTime(uint32_t airport, int minutes) {
+    track(airport);
+    minConnection[airport] = minutes < 0 ? -1 : minutes;
+}
+
+int Timetable::minConnectionTime(uint32_t airport) const {
+    if (airport < minConnection.size() && minConnection[airport] >= 0) {
+        return minConnection[airport];
+    }
+    return defaultMinConnection;
+}
+
+void Timetable::sort() {
+    // Scans rely on departure order only; arrival breaks ties for determinism
+    stable_sort(connections.begin(), connections.end(), [](const Connection& a, const Connection& b) {
+        return a.departure != b.departure ? a.departure < b.departure : a.arrival < b.arrival;
+    });
+    ordered = true;
+}
+
+int Timetable::earliestArrival(uint32_t src, uint32_t target, int departAfter, vector<uint32_t>& legs,
+                               SearchWorkspace& workspace) const {
+    legs.clear();
+    uint32_t n = static_cast<uint32_t>(minConnection.size());
+    if (src >= n || target >= n) {
+        return -1;
+    }
+
+    // label.dist is when an airport is ready for its next departure, and
+    // label.via the connection that got us there
+    StampedArray<SearchLabel>& ready = workspace.labels[0];
+    ready.reset(n, SearchLabel{UNREACHED, NO_CONNECTION});
+    ready.at(src) = SearchLabel{departAfter, NO_CONNECTION};
+
+    int best = UNREACHED;
+    uint32_t bestConnection = NO_CONNECTION;
+    auto first = lower_bound(connections.begin(), connections.end(), departAfter,
+                             [](const Connection& c, int time) { return c.departure < time; });
+    for (auto it = first; it != connections.end(); ++it) {
+        const Connection& c = *it;
+        // Everything from here on departs too late to beat the best arrival
+        if (c.departure >= best) break;
+        if (ready[c.from].dist > c.departure) continue;
+        uint32_t index = static_cast<uint32_t>(it - connections.begin());
+        if (c.to == target) {
+            if (c.arrival < best) {
+                best = c.arrival;
+                bestConnection = index;
+            }
+            continue;
+        }
+        int readyAt = c.arrival + minConnectionTime(c.to);
+        if (readyAt < ready[c.to].dist) {
+            ready.at(c.to) = SearchLabel{readyAt, index};
+        }
+    }
+    if (bestConnection == NO_CONNECTION) {
+        return -1;
+    }
+
+    // A connection only ever feeds later departures, so the chain is stable
+    for (uint32_t c = bestConnection; c != NO_CONNECTION; c = ready[connections[c].from].via) {
+        legs.push_back(c);
+    }
+    reverse(legs.begin(), legs.end());
+    return best;
+}
+
+long Timetable::firstAfter(const vector<ProfileEntry>& entries, int time) {
+    auto end = partition_point(entries.begin(), entries.end(),
+                               [time](const ProfileEntry& e) { return e.departure >= time; });
+    return static_cast<long>(end - entries.begin()) - 1;
+}
+
+void Timetable::profile(uint32_t src, uint32_t target, int from, int until,
+                        vector<vector<uint32_t>>& journeys) const {
+    journeys.clear();
+    uint32_t n = static_cast<uint32_t>(minConnection.size());
+    if (src >= n || target >= n || src == target) {
+        return;
+    }
+
+    // Scan backwards so every connection sees the final profiles of the
+    // airports it reaches: arrival plus connection time is always later than
+    // its own departure, and those entries are already complete
+    vector<vector<ProfileEntry>> profiles(n);
+    auto first = lower_bound(connections.begin(), connections.end(), from,
+                             [](const Connection& c, int time) { return c.departure < time; });
+    for (auto it = connections.end(); it != first;) {
+        --it;
+        const Connection& c = *it;
+        // Departures past the window must not hide the options inside it
+        if (c.from == target || (c.from == src && c.departure > until)) continue;
+        int arrival = UNREACHED;
+        if (c.to == target) {
+            arrival = c.arrival;
+        } else {
+            const vector<ProfileEntry>& onward = profiles[c.to];
+            long k = firstAfter(onward, c.arrival + minConnectionTime(c.to));
+            if (k >= 0) arrival = onward[k].arrival;
+        }
+        if (arrival == UNREACHED) continue;
+
+        vector<ProfileEntry>& entries = profiles[c.from];
+        if (!entries.empty() && entries.back().arrival <= arrival) continue;
+        ProfileEntry entry{c.departure, arrival, static_cast<uint32_t>(it - connections.begin())};
+        if (!entries.empty() && entries.back().departure == c.departure) {
+            entries.back() = entry;
+        } else {
+            entries.push_back(entry);
+        }
+    }
+
+    const vector<ProfileEntry>& options = profiles[src];
+    for (auto it = options.rbegin(); it != options.rend(); ++it) {
+        vector<uint32_t> legs{it->connection};
+        while (connections[legs.back()].to != target) {
+            const Connection& c = connections[legs.back()];
+            const vector<ProfileEntry>& onward = profiles[c.to];
+            legs.push_back(onward[firstAfter(onward, c.arrival + minConnectionTime(c.to))].connection);
+        }
+        journeys.push_back(move(legs));
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef TIMETABLE_H
+#define TIMETABLE_H
+
+#include <vector>
+#include <cstdint>
+#include "SearchWorkspace.h"
+
+// Scheduled flights of one service day as a connection array sorted by
+// departure, answered by Connection Scan. Times are minutes after midnight of
+// the service day; an overnight flight simply arrives after 1440. Changing
+// planes at an airport takes at least its minimum connection time, while the
+// first departure and the final arrival need no buffer.
+class Timetable {
+public:
+    static const uint32_t NO_CONNECTION = UINT32_MAX;
+
+    struct Connection {
+        uint32_t from, to;
+        int departure, arrival;
+        int distance, cost;
+    };
+
+    Timetable() : defaultMinConnection(30), ordered(true) {}
+
+    void clear();
+    // Connections may arrive in any order; queries sort them first. Arrival
+    // must be later than departure.
+    void addConnection(const Connection& connection);
+    // Negative minutes fall back to the default
+    void setMinConnectionTime(uint32_t airport, int minutes);
+    void setDefaultMinConnectionTime(int minutes) { defaultMinConnection = minutes; }
+    int minConnectionTime(uint32_t airport) const;
+    int defaultMinConnectionTime() const { return defaultMinConnection; }
+
+    void sort();
+    bool sorted() const { return ordered; }
+    size_t size() const { return connections.size(); }
+    const Connection& connection(uint32_t index) const { return connections[index]; }
+    const std::vector<Connection>& allConnections() const { return connections; }
+    // Per-airport overrides, -1 where the default applies
+    const std::vector<int>& minConnectionTimes() const { return minConnection; }
+
+    // Earliest arrival at target leaving src no sooner than departAfter. Fills
+    // legs with the connections taken and returns the arrival time, or -1
+    // when target cannot be reached that day. Requires sort().
+    int earliestArrival(uint32_t src, uint32_t target, int departAfter, std::vector<uint32_t>& legs,
+                        SearchWorkspace& workspace) const;
+    // Every journey from src to target departing within [from, until] that
+    // no other such journey beats by leaving later and arriving no later, in
+    // order of departure. Requires sort().
+    void profile(uint32_t src, uint32_t target, int from, int until,
+                 std::vector<std::vector<uint32_t>>& journeys) const;
+
+private:
+    // Best known arrival at the target when taking connection from the
+    // entry's airport; per airport, departures and arrivals both decrease
+    struct ProfileEntry {
+        int departure, arrival;
+        uint32_t connection;
+    };
+
+    std::vector<Connection> connections;
+    std::vector<int> minConnection;  // per airport, -1 for the default; also bounds the airport ids seen
+    int defaultMinConnection;
+    bool ordered;
+
+    void track(uint32_t airport);
+    // Index of the earliest entry departing at or after time, or -1
+    static long firstAfter(const std::vector<ProfileEntry>& entries, int time);
+};
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef WEIGHTPOLICY_H
+#define WEIGHTPOLICY_H
+
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+
+// Objective a route search minimises: total distance, total cost, number of
+// flights, or distanceWeight * distance + costWeight * cost. Blend weights
+// must be non-negative and small enough that route totals fit in an int.
+struct RouteMetric {
+    enum Kind : uint8_t { Distance, Cost, Hops, Linear };
+    Kind kind;
+    int distanceWeight, costWeight;
+
+    static RouteMetric distance() { return RouteMetric(Distance, 1, 0); }
+    static RouteMetric cost() { return RouteMetric(Cost, 0, 1); }
+    static RouteMetric hops() { return RouteMetric(Hops, 0, 0); }
+    static RouteMetric linear(int distanceWeight, int costWeight) {
+        return RouteMetric(Linear, distanceWeight, costWeight);
+    }
+    static RouteMetric of(bool useCost) { return useCost ? cost() : distance(); }
+
+    // Distance and cost are the metrics that tables, landmarks and hierarchies exist for
+    bool isBasic() const { return kind == Distance || kind == Cost; }
+    bool usesCost() const { return kind == Cost; }
+    bool valid() const { return distanceWeight >= 0 && costWeight >= 0; }
+
+    bool operator==(const RouteMetric& other) const {
+        return kind == other.kind && distanceWeight == other.distanceWeight && costWeight == other.costWeight;
+    }
+
+private:
+    RouteMetric(Kind k, int a, int b) : kind(k), distanceWeight(a), costWeight(b) {}
+};
+
+// Weight policies for the templated search engines. Each one maps a csr edge
+// id to its weight, so every metric gets its own relaxation loop with the
+// load (or constant) inlined instead of a runtime choice per flight. maxStep
+// bounds any flight's weight given the largest distance and cost.
+struct DistanceWeight {
+    const int* distances;
+    DistanceWeight(const std::vector<int>& d, const std::vector<int>&) : distances(d.data()) {}
+    int operator()(uint32_t edge) const { return distances[edge]; }
+    int maxStep(int maxDistance, int) const { return maxDistance; }
+};
+
+struct CostWeight {
+    const int* costs;
+    CostWeight(const std::vector<int>&, const std::vector<int>& c) : costs(c.data()) {}
+    int operator()(uint32_t edge) const { return costs[edge]; }
+    int maxStep(int, int maxCost) const { return maxCost; }
+};
+
+struct HopWeight {
+    HopWeight(const std::vector<int>&, const std::vector<int>&) {}
+    int operator()(uint32_t) const { return 1; }
+    int maxStep(int, int) const { return 1; }
+};
+
+struct LinearWeight {
+    const int* distances;
+    const int* costs;
+    int distanceWeight, costWeight;
+    LinearWeight(const std::vector<int>& d, const std::vector<int>& c, int a, int b)
+        : distances(d.data()), costs(c.data()), distanceWeight(a), costWeight(b) {}
+    int operator()(uint32_t edge) const {
+        return distanceWeight * distances[edge] + costWeight * costs[edge];
+    }
+    int maxStep(int maxDistance, int maxCost) const {
+        long long step = static_cast<long long>(distanceWeight) * maxDistance +
+                         static_cast<long long>(costWeight) * maxCost;
+        return static_cast<int>(std::min<long long>(step, INT32_MAX));
+    }
+};
+
+// Calls visit with the policy for metric over the given distance and cost
+// columns and returns its result
+template <class Visitor>
+auto withWeightPolicy(const RouteMetric& metric, const std::vector<int>& distances,
+                      const std::vector<int>& costs, Visitor&& visit) -> decltype(visit(HopWeight(distances, costs))) {
+    switch (metric.kind) {
+        case RouteMetric::Distance:
+            return visit(DistanceWeight(distances, costs));
+        case RouteMetric::Cost:
+            return visit(CostWeight(distances, costs));
+        case RouteMetric::Hops:
+            return visit(HopWeight(distances, costs));
+        default:
+            return visit(LinearWeight(distances, costs, metric.distanceWeight, metric.costWeight));
+    }
+}
+
+#endif
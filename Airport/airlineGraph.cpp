@@ -1,334 +1,1074 @@
 #include "airlineGraph.h"
-#include <fstream>
-#include <sstream>
+#include "MappedFile.h"
+#include "IndexedHeap.h"
+#include <charconv>
+#include <string_view>
 #include <algorithm>
 #include <limits>
 #include <queue>
 #include <iostream>
+#include <atomic>
 
 using namespace std;
 
-DisjointSet::DisjointSet(int size) : parent(size), rank(size, 0) {
-    for (int i = 0; i < size; ++i) {
-        parent[i] = i;
+uint32_t CSRGraph::edgeSource(uint32_t edge) const {
+    // offsets is non-decreasing, so the owning row is the last offset <= edge
+    auto it = upper_bound(offsets.begin(), offsets.end(), edge);
+    return static_cast<uint32_t>(it - offsets.begin()) - 1;
+}
+
+uint32_t airlineGraph::getIndex(const string& air_code) const {
+    auto it = airportIds.find(air_code);
+    return it == airportIds.end() ? INVALID_AIRPORT : it->second;
+}
+
+uint32_t airlineGraph::internAirport(const string& air_code) {
+    auto it = airportIds.find(air_code);
+    if (it != airportIds.end()) {
+        return it->second;
     }
+    uint32_t id = static_cast<uint32_t>(airportCodes.size());
+    airportIds.emplace(air_code, id);
+    airportCodes.push_back(air_code);
+    airportStates.emplace_back();
+    airportLat.push_back(numeric_limits<double>::quiet_NaN());
+    airportLon.push_back(numeric_limits<double>::quiet_NaN());
+    inDegree.push_back(0);
+    outDegree.push_back(0);
+    csrDirty = true;
+    graphVersion++;
+    return id;
 }
 
-int DisjointSet::find(int v) {
-    if (parent[v] != v) {
-        parent[v] = find(parent[v]);
+uint32_t airlineGraph::addAirportNode(const string& air_code, const string& state_code) {
+    uint32_t id = internAirport(air_code);
+    if (airportStates[id].empty()) {
+        airportStates[id] = state_code;
+        graphVersion++;
     }
-    return parent[v];
+    return id;
 }
 
-void DisjointSet::unionSet(int u, int v) {
-    int rootU = find(u);
-    int rootV = find(v);
-    if (rootU != rootV) {
-        if (rank[rootU] < rank[rootV]) {
-            parent[rootU] = rootV;
-        } else if (rank[rootU] > rank[rootV]) {
-            parent[rootV] = rootU;
-        } else {
-            parent[rootV] = rootU;
-            rank[rootU]++;
+void airlineGraph::setAirportLocation(const string& air_code, double lat, double lon) {
+    uint32_t id = internAirport(air_code);
+    airportLat[id] = lat;
+    airportLon[id] = lon;
+    csrDirty = true;  // the geometric bound is recalibrated on the next freeze
+    graphVersion++;
+}
+
+void airlineGraph::addFlightEdge(const string& origin, const string& dest, int dist, int cost) {
+    appendFlight(internAirport(origin), internAirport(dest), dist, cost);
+}
+
+void airlineGraph::appendFlight(uint32_t from, uint32_t to, int dist, int cost) {
+    flights.emplace_back(from, to, dist, cost);
+    outDegree[from]++;
+    inDegree[to]++;
+    csrDirty = true;
+    graphVersion++;
+}
+
+void airlineGraph::freeze() {
+    uint32_t n = static_cast<uint32_t>(airportCodes.size());
+    csr.offsets.assign(n + 1, 0);
+    for (const auto& flight : flights) {
+        csr.offsets[flight.origin + 1]++;
+    }
+    for (uint32_t i = 0; i < n; ++i) {
+        csr.offsets[i + 1] += csr.offsets[i];
+    }
+
+    // Counting sort by origin keeps each airport's flights in insertion order.
+    // flights is stored back in the same order so its indices match csr edges.
+    csr.targets.resize(flights.size());
+    csr.distances.resize(flights.size());
+    csr.costs.resize(flights.size());
+    vector<Flight> ordered(flights.size());
+    vector<uint32_t> cursor(csr.offsets.begin(), csr.offsets.end() - 1);
+    for (const auto& flight : flights) {
+        uint32_t slot = cursor[flight.origin]++;
+        csr.targets[slot] = flight.destination;
+        csr.distances[slot] = flight.distance;
+        csr.costs[slot] = flight.cost;
+        ordered[slot] = flight;
+    }
+    flights.swap(ordered);
+    csrDirty = false;
+    onGraphFrozen();
+}
+
+void airlineGraph::onGraphFrozen() {
+    // Precomputed tables describe the previous edge arrays
+    resetWeightTables();
+    dynamicTrees[0].clear();
+    dynamicTrees[1].clear();
+    maxWeight[0] = csr.distances.empty() ? 0 : *max_element(csr.distances.begin(), csr.distances.end());
+    maxWeight[1] = csr.costs.empty() ? 0 : *max_element(csr.costs.begin(), csr.costs.end());
+    buildComponentIndex();
+    buildReverseGraph();
+    calibrateGeoBound();
+}
+
+bool airlineGraph::setQueueKind(SearchMode mode, QueueKind kind) {
+    if (mode == SearchMode::Dijkstra) {
+        dijkstraQueue = kind;
+    } else if (mode == SearchMode::Bidirectional) {
+        bidirectionalQueue = kind;
+    } else {
+        cerr << "Only the Dijkstra and Bidirectional searches take a queue kind" << endl;
+        return false;
+    }
+    return true;
+}
+
+QueueKind airlineGraph::getQueueKind(SearchMode mode) const {
+    if (mode == SearchMode::Dijkstra) return dijkstraQueue;
+    if (mode == SearchMode::Bidirectional) return bidirectionalQueue;
+    return QueueKind::BinaryHeap;
+}
+
+void airlineGraph::resetWeightTables() {
+    allPairs[0] = AllPairsTable();
+    allPairs[1] = AllPairsTable();
+    landmarkTable = LandmarkTable();
+    hierarchies[0] = ContractionHierarchy();
+    hierarchies[1] = ContractionHierarchy();
+}
+
+void airlineGraph::buildComponentIndex() {
+    uint32_t n = csr.nodeCount();
+    const uint32_t UNVISITED = UINT32_MAX;
+    components.scc.assign(n, UNVISITED);
+    components.sccCount = 0;
+
+    // Iterative Tarjan; each frame is an airport and the next flight to explore
+    vector<uint32_t> order(n, UNVISITED), low(n);
+    vector<bool> onStack(n, false);
+    vector<uint32_t> stack;
+    vector<pair<uint32_t, uint32_t>> frames;
+    uint32_t counter = 0;
+
+    for (uint32_t root = 0; root < n; ++root) {
+        if (order[root] != UNVISITED) continue;
+        order[root] = low[root] = counter++;
+        stack.push_back(root);
+        onStack[root] = true;
+        frames.push_back({root, csr.offsets[root]});
+
+        while (!frames.empty()) {
+            uint32_t v = frames.back().first;
+            uint32_t e = frames.back().second;
+            if (e < csr.offsets[v + 1]) {
+                frames.back().second++;
+                uint32_t w = csr.targets[e];
+                if (order[w] == UNVISITED) {
+                    order[w] = low[w] = counter++;
+                    stack.push_back(w);
+                    onStack[w] = true;
+                    frames.push_back({w, csr.offsets[w]});
+                } else if (onStack[w]) {
+                    low[v] = min(low[v], order[w]);
+                }
+                continue;
+            }
+
+            if (low[v] == order[v]) {
+                uint32_t w;
+                do {
+                    w = stack.back();
+                    stack.pop_back();
+                    onStack[w] = false;
+                    components.scc[w] = components.sccCount;
+                } while (w != v);
+                components.sccCount++;
+            }
+            frames.pop_back();
+            if (!frames.empty()) {
+                uint32_t parent = frames.back().first;
+                low[parent] = min(low[parent], low[v]);
+            }
+        }
+    }
+
+    // Condensation DAG, one edge per connected pair of components
+    vector<pair<uint32_t, uint32_t>> links;
+    DisjointSet weak(n);
+    for (uint32_t from = 0; from < n; ++from) {
+        for (uint32_t e = csr.offsets[from]; e < csr.offsets[from + 1]; ++e) {
+            uint32_t to = csr.targets[e];
+            weak.unionSet(from, to);
+            if (components.scc[from] != components.scc[to]) {
+                links.push_back({components.scc[from], components.scc[to]});
+            }
         }
     }
+    sort(links.begin(), links.end());
+    links.erase(unique(links.begin(), links.end()), links.end());
+    components.dagOffsets.assign(components.sccCount + 1, 0);
+    components.dagTargets.resize(links.size());
+    for (size_t i = 0; i < links.size(); ++i) {
+        components.dagOffsets[links[i].first + 1]++;
+        components.dagTargets[i] = links[i].second;
+    }
+    for (uint32_t i = 0; i < components.sccCount; ++i) {
+        components.dagOffsets[i + 1] += components.dagOffsets[i];
+    }
+
+    components.weak.assign(n, UNVISITED);
+    components.weakCount = 0;
+    vector<uint32_t> weakLabel(n, UNVISITED);
+    for (uint32_t v = 0; v < n; ++v) {
+        uint32_t root = weak.find(v);
+        if (weakLabel[root] == UNVISITED) weakLabel[root] = components.weakCount++;
+        components.weak[v] = weakLabel[root];
+    }
 }
 
-bool airlineGraph::airportExists(const string& air_code) const {
-    return airportToState.find(air_code) != airportToState.end();
+bool airlineGraph::mayReach(uint32_t src, uint32_t target) const {
+    // Tarjan numbers components sinks first, so every flight leads to an equal
+    // or lower component number
+    return components.weak[src] == components.weak[target] &&
+           components.scc[src] >= components.scc[target];
 }
 
-vector<string> airlineGraph::getAllAirports() const {
-    vector<string> airports;
-    for (const auto& pair : airportToState) {
-        airports.push_back(pair.first);
+bool airlineGraph::hasRoute(const string& origin, const string& dest) {
+    uint32_t src = getIndex(origin);
+    uint32_t target = getIndex(dest);
+    if (src == INVALID_AIRPORT || target == INVALID_AIRPORT) {
+        return false;
     }
-    return airports;
+    ensureFrozen();
+    if (!mayReach(src, target)) return false;
+
+    // Exact answer from a walk over the (much smaller) condensation DAG
+    uint32_t goal = components.scc[target];
+    vector<bool> seen(components.sccCount, false);
+    vector<uint32_t> pending = {components.scc[src]};
+    seen[pending.back()] = true;
+    while (!pending.empty()) {
+        uint32_t comp = pending.back();
+        pending.pop_back();
+        if (comp == goal) return true;
+        for (uint32_t i = components.dagOffsets[comp]; i < components.dagOffsets[comp + 1]; ++i) {
+            uint32_t next = components.dagTargets[i];
+            if (next >= goal && !seen[next]) {
+                seen[next] = true;
+                pending.push_back(next);
+            }
+        }
+    }
+    return false;
 }
 
-int airlineGraph::getIndex(const string& air_code) const {
-    auto airports = getAllAirports();
-    for (size_t i = 0; i < airports.size(); ++i) {
-        if (airports[i] == air_code) return static_cast<int>(i);
+void airlineGraph::ensureFrozen() {
+    // A graph that was never frozen has no offsets row yet, even when empty
+    if (csrDirty || csr.offsets.empty()) {
+        freeze();
     }
-    return -1;
 }
 
-void airlineGraph::addAirportNode(const string& air_code, const string& state_code) {
-    if (!airportExists(air_code)) {
-        airportToState[air_code] = state_code;
+Path airlineGraph::edgePath(uint32_t origin, const vector<uint32_t>& edges) const {
+    Path path;
+    path.air_code.push_back(airportCodes[origin]);
+    for (uint32_t e : edges) {
+        path.air_code.push_back(airportCodes[csr.targets[e]]);
+        path.totalDistance += csr.distances[e];
+        path.totalCost += csr.costs[e];
     }
+    return path;
 }
 
-void airlineGraph::addFlightEdge(const string& origin, const string& dest, int dist, int cost) {
-    Flight flight(dest, dist, cost);
-    adjList[origin].push_back(flight);
+Path airlineGraph::buildPath(uint32_t origin, uint32_t dest, const vector<uint32_t>& prevEdge) const {
+    vector<uint32_t> edges;
+    for (uint32_t at = dest; at != origin; at = csr.edgeSource(edges.back())) {
+        edges.push_back(prevEdge[at]);
+    }
+    reverse(edges.begin(), edges.end());
+    return edgePath(origin, edges);
 }
 
-string extractState(const string& cityState) {
-    size_t comma = cityState.find(",");
-    if (comma != string::npos && comma + 2 < cityState.length()) {
-        string state = cityState.substr(comma + 2);
-        if (state.front() == '"') state = state.substr(1, state.size() - 2);
-        return state;
+Path airlineGraph::buildPath(uint32_t origin, uint32_t dest, const StampedArray<SearchLabel>& labels) const {
+    vector<uint32_t> edges;
+    for (uint32_t at = dest; at != origin; at = csr.edgeSource(edges.back())) {
+        edges.push_back(labels[at].via);
     }
-    return "";
+    reverse(edges.begin(), edges.end());
+    return edgePath(origin, edges);
 }
 
-void airlineGraph::readCSV(const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
+// State code from a "City, ST" field
+static string_view extractState(string_view cityState) {
+    size_t comma = cityState.find(',');
+    if (comma != string_view::npos && comma + 2 < cityState.length()) {
+        return cityState.substr(comma + 2);
+    }
+    return string_view();
+}
+
+// Splits one CSV row into views over the row itself, dropping the quotes around
+// quoted fields. Returns the field count even if it exceeds maxFields.
+static size_t splitCSVLine(string_view line, string_view* fields, size_t maxFields) {
+    size_t count = 0;
+    size_t start = 0;
+    bool in_quotes = false;
+    for (size_t i = 0; i <= line.size(); ++i) {
+        if (i < line.size() && line[i] == '"') {
+            in_quotes = !in_quotes; //toggle quote state
+            continue;
+        }
+        if (i < line.size() && (line[i] != ',' || in_quotes)) continue;
+
+        string_view field = line.substr(start, i - start);
+        if (field.size() >= 2 && field.front() == '"' && field.back() == '"') {
+            field = field.substr(1, field.size() - 2);
+        }
+        if (count < maxFields) fields[count] = field;
+        count++;
+        start = i + 1;
+    }
+    return count;
+}
+
+static bool parseInt(string_view text, int& value) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) text.remove_prefix(1);
+    auto result = from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == errc() && result.ptr != text.data();
+}
+
+// "HH:MM" as minutes after midnight
+static bool parseClock(string_view text, int& minutes) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) text.remove_prefix(1);
+    size_t colon = text.find(':');
+    int hours, mins;
+    if (colon == string_view::npos || !parseInt(text.substr(0, colon), hours) ||
+        !parseInt(text.substr(colon + 1), mins) || hours < 0 || hours > 23 || mins < 0 || mins > 59) {
+        return false;
+    }
+    minutes = hours * 60 + mins;
+    return true;
+}
+
+static bool parseDouble(string_view text, double& value) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) text.remove_prefix(1);
+    auto result = from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == errc() && result.ptr != text.data();
+}
+
+bool airlineGraph::readCSV(const std::string& filename) {
+    MappedFile file;
+    if (!file.open(filename)) {
         std::cerr << "Error opening file: " << filename << std::endl;
-        return;
+        return false;
     }
 
-    std::string line;
-    getline(file, line); // Skip header
+    string_view text = file.view();
+    flights.reserve(flights.size() + count(text.begin(), text.end(), '\n'));
 
-    while (getline(file, line)) {
-        std::vector<std::string> fields;
-        std::string field;
-        bool in_quotes = false;
-        char c;
+    size_t pos = text.find('\n'); // Skip header
+    pos = (pos == string_view::npos) ? text.size() : pos + 1;
 
-        for (size_t i = 0; i < line.size(); ++i) {
-            c = line[i];
+    // Reused for every row; airport and state codes fit the small-string buffer
+    std::string originAir, destAir, originState, destState;
+    string_view fields[12];
 
-            if (c == '"') {
-                in_quotes = !in_quotes; //toggle quote state
-                continue;
-            }
+    while (pos < text.size()) {
+        size_t end = text.find('\n', pos);
+        if (end == string_view::npos) end = text.size();
+        string_view line = text.substr(pos, end - pos);
+        pos = end + 1;
 
-            if (c == ',' && !in_quotes) {
-                fields.push_back(field); //end of field
-                field.clear();
-                continue;
-            }
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        if (line.empty()) continue;
 
-            field += c; //add character to current field
+        // Six columns, optionally followed by origin and destination lat/lon,
+        // then optionally by scheduled departure and arrival as HH:MM. An
+        // arrival no later than the departure lands the next day.
+        size_t fieldCount = splitCSVLine(line, fields, 12);
+        if (fieldCount != 6 && fieldCount != 8 && fieldCount != 10 && fieldCount != 12) {
+            std::cerr << "Invalid CSV line: " << line << std::endl;
+            continue;
         }
-        fields.push_back(field); //add the last field
 
-        if (fields.size() != 6) {
-            std::cerr << "Invalid CSV line: " << line << std::endl;
+        int distance, cost;
+        if (!parseInt(fields[4], distance) || !parseInt(fields[5], cost)) {
+            std::cerr << "Error parsing numbers in line: " << line << std::endl;
+            continue;
+        }
+        bool located = fieldCount >= 10;
+        double coords[4];
+        bool parsed = true;
+        for (int i = 0; located && i < 4 && parsed; ++i) {
+            parsed = parseDouble(fields[6 + i], coords[i]);
+        }
+        if (!parsed) {
+            std::cerr << "Error parsing coordinates in line: " << line << std::endl;
             continue;
         }
+        bool scheduled = fieldCount == 8 || fieldCount == 12;
+        int departure = 0, arrival = 0;
+        if (scheduled) {
+            if (!parseClock(fields[fieldCount - 2], departure) || !parseClock(fields[fieldCount - 1], arrival)) {
+                std::cerr << "Error parsing flight times in line: " << line << std::endl;
+                continue;
+            }
+            if (arrival <= departure) arrival += 24 * 60;
+        }
 
-        std::string originAir = fields[0];
-        std::string destAir = fields[1];
-        std::string originCityState = fields[2];
-        std::string destCityState = fields[3];
-        std::string distanceStr = fields[4];
-        std::string costStr = fields[5];
+        originAir.assign(fields[0]);
+        destAir.assign(fields[1]);
+        originState.assign(extractState(fields[2]));
+        destState.assign(extractState(fields[3]));
 
-        if (!originCityState.empty() && originCityState.front() == '"' && originCityState.back() == '"') {
-            originCityState = originCityState.substr(1, originCityState.size() - 2);
+        uint32_t from = addAirportNode(originAir, originState);
+        uint32_t to = addAirportNode(destAir, destState);
+        if (scheduled) {
+            appendScheduledFlight(from, to, departure, arrival, distance, cost);
+        } else {
+            appendFlight(from, to, distance, cost);
         }
-        if (!destCityState.empty() && destCityState.front() == '"' && destCityState.back() == '"') {
-            destCityState = destCityState.substr(1, destCityState.size() - 2);
+
+        if (located) {
+            airportLat[from] = coords[0];
+            airportLon[from] = coords[1];
+            airportLat[to] = coords[2];
+            airportLon[to] = coords[3];
         }
+    }
+    freeze();
+    return true;
+}
 
-        std::string originState = extractState(originCityState);
-        std::string destState = extractState(destCityState);
+void airlineGraph::shortestPathTree(uint32_t src, const RouteMetric& metric, const vector<uint32_t>& targets,
+                                    vector<int>& dist, vector<uint32_t>& prevEdge) const {
+    SearchWorkspace& workspace = SearchWorkspace::local();
+    withWeightPolicy(metric, csr.distances, csr.costs, [&](auto weight) {
+        int maxStep = weight.maxStep(maxWeight[0], maxWeight[1]);
+        workspace.withQueues(dijkstraQueue, maxStep, [&](auto& pq, auto&) {
+            growTree(src, weight, pq, targets, dist, prevEdge);
+        });
+    });
+}
 
-        try {
-            int distance = std::stoi(distanceStr);
-            int cost = std::stoi(costStr);
-            addAirportNode(originAir, originState);
-            addAirportNode(destAir, destState);
-            addFlightEdge(originAir, destAir, distance, cost);
-        } catch (const std::exception& e) {
-            std::cerr << "Error parsing numbers in line: " << line << " (" << e.what() << ")" << std::endl;
-            continue;
+template <class Weight, class Queue>
+void airlineGraph::growTree(uint32_t src, Weight weight, Queue& pq, const vector<uint32_t>& targets,
+                            vector<int>& dist, vector<uint32_t>& prevEdge) const {
+    dist.assign(csr.nodeCount(), UNREACHED);
+    prevEdge.assign(csr.nodeCount(), INVALID_AIRPORT);
+
+    StampedArray<uint8_t>& isTarget = SearchWorkspace::local().airportFlags;
+    isTarget.reset(csr.nodeCount(), 0);
+    size_t remaining = 0;
+    for (uint32_t t : targets) {
+        if (!isTarget[t]) {
+            isTarget.at(t) = 1;
+            remaining++;
+        }
+    }
+
+    dist[src] = 0;
+    pq.push({0, src});
+
+    while (!pq.empty()) {
+        int curDist = pq.top().first;
+        uint32_t cur = pq.top().second;
+        pq.pop();
+
+        if (curDist > dist[cur]) continue;
+        // Every push strictly improves dist, so the first non-stale pop settles cur
+        if (isTarget[cur] && --remaining == 0) break;
+
+        for (uint32_t e = csr.offsets[cur]; e < csr.offsets[cur + 1]; ++e) {
+            uint32_t next = csr.targets[e];
+            if (curDist + weight(e) < dist[next]) {
+                dist[next] = curDist + weight(e);
+                prevEdge[next] = e;
+                pq.push({dist[next], next});
+            }
         }
     }
-    file.close();
 }
 
-Path airlineGraph::dijkstraPath(const string& origin, const string& dest, bool useCost) {
-    if (!airportExists(origin) || !airportExists(dest)) {
+Path airlineGraph::dijkstraPath(const string& origin, const string& dest, const RouteMetric& metric, SearchMode mode) {
+    uint32_t src = getIndex(origin);
+    uint32_t target = getIndex(dest);
+    if (src == INVALID_AIRPORT || target == INVALID_AIRPORT) {
         return Path();
     }
+    if (!metric.valid()) {
+        cerr << "Route metric weights must be non-negative" << endl;
+        return Path();
+    }
+    QueryKey key(QueryKey::Route, src, target, metric);
+    if (const vector<Path>* cached = queryCache.find(key, graphVersion)) {
+        return cached->front();
+    }
+    ensureFrozen();
+    if (metric.isBasic()) {
+        bool useCost = metric.usesCost();
+        if (mode == SearchMode::AStar && !landmarkTable.ready()) {
+            buildLandmarks();
+        }
+        if (mode == SearchMode::Hierarchy && !hierarchies[useCost].ready()) {
+            buildContractionHierarchy(useCost);
+        }
+        if (mode == SearchMode::Dynamic && dynamicTreeLimit > 0) {
+            auto it = dynamicTrees[useCost].find(src);
+            if (it == dynamicTrees[useCost].end()) {
+                trimDynamicTrees(useCost, dynamicTreeLimit - 1);
+                it = dynamicTrees[useCost].emplace(src, ShortestPathTree()).first;
+                shortestPathTree(src, metric, {}, it->second.dist, it->second.prevEdge);
+            }
+            it->second.lastUsed = ++dynamicClock;
+        }
+    }
+    Path path = searchPath(src, target, metric, mode);
+    queryCache.insert(key, {path}, graphVersion);
+    return path;
+}
 
-    unordered_map<string, int> dist;
-    unordered_map<string, string> prev;
-    priority_queue<pair<int, string>, vector<pair<int, string>>, greater<pair<int, string>>> pq;
-
-    for (const auto& airport : airportToState) {
-        dist[airport.first] = numeric_limits<int>::max();
+Path airlineGraph::searchPath(uint32_t src, uint32_t target, const RouteMetric& metric, SearchMode mode) const {
+    if (!mayReach(src, target)) {
+        return Path();
     }
-    
-    dist[origin] = 0;
-    pq.push({0, origin});
+    if (metric.isBasic()) {
+        bool useCost = metric.usesCost();
+        if (allPairs[useCost].ready()) {
+            return tablePath(allPairs[useCost], src, target);
+        }
+        if (mode == SearchMode::AStar) {
+            return aStarPath(src, target, useCost);
+        }
+        if (mode == SearchMode::Hierarchy && hierarchies[useCost].ready()) {
+            return hierarchyPath(src, target, useCost);
+        }
+        if (mode == SearchMode::Dynamic) {
+            auto it = dynamicTrees[useCost].find(src);
+            if (it != dynamicTrees[useCost].end()) {
+                if (it->second.dist[target] == UNREACHED) {
+                    return Path();
+                }
+                return buildPath(src, target, it->second.prevEdge);
+            }
+        }
+    }
+    if (mode == SearchMode::Bidirectional) {
+        return bidirectionalPath(src, target, metric);
+    }
+    SearchWorkspace& workspace = SearchWorkspace::local();
+    return withWeightPolicy(metric, csr.distances, csr.costs, [&](auto weight) {
+        int maxStep = weight.maxStep(maxWeight[0], maxWeight[1]);
+        return workspace.withQueues(dijkstraQueue, maxStep, [&](auto& pq, auto&) {
+            return pointSearch(src, target, weight, pq);
+        });
+    });
+}
+
+template <class Weight, class Queue>
+Path airlineGraph::pointSearch(uint32_t src, uint32_t target, Weight weight, Queue& pq) const {
+    // Plain Dijkstra on the calling thread's workspace, so nothing is
+    // allocated or cleared beyond the airports the search reaches
+    StampedArray<SearchLabel>& labels = SearchWorkspace::local().labels[0];
+    labels.reset(csr.nodeCount(), {UNREACHED, INVALID_AIRPORT});
+
+    labels.at(src).dist = 0;
+    pq.push({0, src});
 
     while (!pq.empty()) {
-        pair<int, string> top = pq.top();
-        int curDist = top.first;
-        string cur = top.second;
+        int curDist = pq.top().first;
+        uint32_t cur = pq.top().second;
         pq.pop();
 
-        if (cur == dest) break;
-        if (curDist > dist[cur]) continue;
+        if (curDist > labels[cur].dist) continue;
+        if (cur == target) break;
 
-        for (const auto& flight : adjList[cur]) {
-            int weight = useCost ? flight.cost : flight.distance;
-            if (dist[cur] + weight < dist[flight.destination]) {
-                dist[flight.destination] = dist[cur] + weight;
-                prev[flight.destination] = cur;
-                pq.push({dist[flight.destination], flight.destination});
+        for (uint32_t e = csr.offsets[cur]; e < csr.offsets[cur + 1]; ++e) {
+            uint32_t next = csr.targets[e];
+            if (curDist + weight(e) < labels[next].dist) {
+                labels.at(next) = {curDist + weight(e), e};
+                pq.push({curDist + weight(e), next});
             }
         }
     }
 
-    Path path;
-    if (dist[dest] == numeric_limits<int>::max()) {
-        return path;
+    if (labels[target].dist == UNREACHED) {
+        return Path();
     }
+    return buildPath(src, target, labels);
+}
 
-    for (string at = dest; !at.empty(); at = prev[at]) {
-        path.air_code.push_back(at);
-        if (at == origin) break;
-    }
-    
-    reverse(path.air_code.begin(), path.air_code.end());
-    
-    for (size_t i = 1; i < path.air_code.size(); ++i) {
-        string from = path.air_code[i-1];
-        string to = path.air_code[i];
-        for (const auto& flight : adjList[from]) {
-            if (flight.destination == to) {
-                path.totalDistance += flight.distance;
-                path.totalCost += flight.cost;
-                break;
+void airlineGraph::precomputeAllPairs(unsigned threads) {
+    ensureFrozen();
+    uint32_t n = csr.nodeCount();
+    ThreadPool pool(threads);
+
+    for (int useCost = 0; useCost < 2; ++useCost) {
+        AllPairsTable table;
+        table.n = n;
+        table.dist.assign(static_cast<size_t>(n) * n, UNREACHED);
+        table.nextEdge.assign(static_cast<size_t>(n) * n, INVALID_AIRPORT);
+
+        // Rows are independent, so workers pull source airports off a shared counter
+        atomic<uint32_t> nextSource(0);
+        const vector<uint32_t> allTargets;  // empty, so each search builds the full tree
+        auto worker = [&]() {
+            vector<int> dist;
+            vector<uint32_t> prevEdge;
+            for (uint32_t src = nextSource++; src < n; src = nextSource++) {
+                shortestPathTree(src, RouteMetric::of(useCost), allTargets, dist, prevEdge);
+                int* rowDist = &table.dist[static_cast<size_t>(src) * n];
+                uint32_t* rowNext = &table.nextEdge[static_cast<size_t>(src) * n];
+                copy(dist.begin(), dist.end(), rowDist);
+
+                // The first flight toward v is the first flight toward v's parent,
+                // unless the parent is src itself; fill it in by memoised walks up the tree
+                vector<uint32_t> chain;
+                for (uint32_t v = 0; v < n; ++v) {
+                    uint32_t at = v;
+                    while (at != src && prevEdge[at] != INVALID_AIRPORT && rowNext[at] == INVALID_AIRPORT) {
+                        chain.push_back(at);
+                        at = csr.edgeSource(prevEdge[at]);
+                    }
+                    uint32_t first = (at == src) ? INVALID_AIRPORT : rowNext[at];
+                    while (!chain.empty()) {
+                        uint32_t child = chain.back();
+                        chain.pop_back();
+                        if (first == INVALID_AIRPORT) first = prevEdge[child];
+                        rowNext[child] = first;
+                    }
+                }
             }
+        };
+
+        for (unsigned t = 0; t < pool.size(); ++t) {
+            pool.submit(worker);
         }
+        pool.wait();
+        allPairs[useCost] = move(table);
+    }
+}
+
+vector<int> airlineGraph::floydWarshallDistances(bool useCost, MinPlusKernel& kernelUsed,
+                                                  MinPlusKernel maxKernel) {
+    ensureFrozen();
+    uint32_t n = csr.nodeCount();
+    const vector<int>& weights = useCost ? csr.costs : csr.distances;
+
+    DistanceMatrix matrix(n);
+    for (uint32_t from = 0; from < n; ++from) {
+        for (uint32_t e = csr.offsets[from]; e < csr.offsets[from + 1]; ++e) {
+            int32_t& cell = matrix.at(from, csr.targets[e]);
+            cell = min(cell, static_cast<int32_t>(min(weights[e], FW_INFINITY)));
+        }
+    }
+    kernelUsed = floydWarshall(matrix, maxKernel);
+
+    vector<int> dist(static_cast<size_t>(n) * n);
+    for (uint32_t i = 0; i < n; ++i) {
+        for (uint32_t j = 0; j < n; ++j) {
+            int32_t cell = matrix.at(i, j);
+            dist[static_cast<size_t>(i) * n + j] = cell >= FW_INFINITY ? UNREACHED : cell;
+        }
+    }
+    return dist;
+}
+
+Path airlineGraph::tablePath(const AllPairsTable& table, uint32_t origin, uint32_t dest) const {
+    size_t n = table.n;
+    if (table.dist[origin * n + dest] == UNREACHED) {
+        return Path();
+    }
+
+    Path path;
+    path.air_code.push_back(airportCodes[origin]);
+    for (uint32_t at = origin; at != dest; ) {
+        uint32_t e = table.nextEdge[at * n + dest];
+        at = csr.targets[e];
+        path.air_code.push_back(airportCodes[at]);
+        path.totalDistance += csr.distances[e];
+        path.totalCost += csr.costs[e];
     }
-    
     return path;
 }
 
-vector<Path> airlineGraph::shortestPathsToState(const string& origin, const string& state, bool useCost) {
+vector<Path> airlineGraph::shortestPathsToState(const string& origin, const string& state, const RouteMetric& metric) {
     vector<Path> paths;
-    for (const auto& airport : airportToState) {
-        if (airport.second == state && airport.first != origin) {
-            Path path = dijkstraPath(origin, airport.first, useCost);
+    uint32_t src = getIndex(origin);
+    if (src == INVALID_AIRPORT) {
+        return paths;
+    }
+    if (!metric.valid()) {
+        cerr << "Route metric weights must be non-negative" << endl;
+        return paths;
+    }
+    QueryKey key(QueryKey::State, src, INVALID_AIRPORT, metric, -1, state);
+    if (const vector<Path>* cached = queryCache.find(key, graphVersion)) {
+        return *cached;
+    }
+    ensureFrozen();
+
+    vector<uint32_t> targets;
+    for (uint32_t id = 0; id < airportCount(); ++id) {
+        if (airportStates[id] == state && id != src && mayReach(src, id)) {
+            targets.push_back(id);
+        }
+    }
+    if (metric.isBasic() && allPairs[metric.usesCost()].ready()) {
+        for (uint32_t target : targets) {
+            Path path = tablePath(allPairs[metric.usesCost()], src, target);
             if (!path.air_code.empty()) {
                 paths.push_back(path);
             }
         }
+    } else if (!targets.empty()) {
+
+        // One search settles every airport in the state; paths share its predecessor tree
+        vector<int> dist;
+        vector<uint32_t> prevEdge;
+        shortestPathTree(src, metric, targets, dist, prevEdge);
+
+        for (uint32_t target : targets) {
+            if (dist[target] != UNREACHED) {
+                paths.push_back(buildPath(src, target, prevEdge));
+            }
+        }
     }
+    queryCache.insert(key, paths, graphVersion);
     return paths;
 }
 
-Path airlineGraph::shortestPathWithStops(const string& origin, const string& dest, int maxStops) {
-    if (!airportExists(origin) || !airportExists(dest)) {
+Path airlineGraph::shortestPathWithStops(const string& origin, const string& dest, int maxStops, bool useCost) {
+    uint32_t src = getIndex(origin);
+    uint32_t target = getIndex(dest);
+    if (src == INVALID_AIRPORT || target == INVALID_AIRPORT || maxStops < 0) {
         return Path();
     }
-
-    queue<pair<string, int>> q;
-    unordered_map<string, int> dist;
-    unordered_map<string, string> prev;
-    unordered_map<string, int> stops;
-
-    for (const auto& airport : airportToState) {
-        dist[airport.first] = numeric_limits<int>::max();
+    QueryKey key(QueryKey::Stops, src, target, RouteMetric::of(useCost), maxStops);
+    if (const vector<Path>* cached = queryCache.find(key, graphVersion)) {
+        return cached->front();
     }
+    ensureFrozen();
+    Path path = searchPathWithStops(src, target, maxStops, useCost);
+    queryCache.insert(key, {path}, graphVersion);
+    return path;
+}
 
-    dist[origin] = 0;
-    q.push({origin, 0});
-
-    while (!q.empty()) {
-        pair<string, int> front = q.front();
-        string cur = front.first;
-        int curStops = front.second;
-        q.pop();
+Path airlineGraph::searchPathWithStops(uint32_t src, uint32_t target, int maxStops, bool useCost) const {
+    if (!mayReach(src, target)) {
+        return Path();
+    }
+    const vector<int>& weights = useCost ? csr.costs : csr.distances;
+    uint32_t n = csr.nodeCount();
 
-        if (cur == dest) break;
-        if (curStops >= maxStops) continue;
+    // Bellman-Ford layered by flight count: after round r, dist holds the best
+    // weight using at most r flights. A cheapest route never needs more than n - 1.
+    // Instead of a full table per round, each airport chains the rounds that
+    // improved it, newest first, through the workspace's improvement log.
+    uint32_t rounds = min(static_cast<uint32_t>(maxStops), n - 1);
+    SearchWorkspace& workspace = SearchWorkspace::local();
+    StampedArray<SearchLabel>& prevDist = workspace.labels[0];
+    StampedArray<SearchLabel>& dist = workspace.labels[1];
+    StampedArray<uint32_t>& lastImprovement = workspace.lastImprovement;
+    StampedArray<uint32_t>& queuedRound = workspace.queuedRound;
+    vector<SearchWorkspace::Improvement>& improvements = workspace.improvements;
+    vector<uint32_t>& frontier = workspace.frontier[0];
+    vector<uint32_t>& nextFrontier = workspace.frontier[1];
+    prevDist.reset(n, {UNREACHED, INVALID_AIRPORT});
+    dist.reset(n, {UNREACHED, INVALID_AIRPORT});
+    lastImprovement.reset(n, INVALID_AIRPORT);
+    queuedRound.reset(n, 0);
+    improvements.clear();
+    frontier.assign(1, src);
+    prevDist.at(src).dist = 0;
+    dist.at(src).dist = 0;
 
-        for (const auto& flight : adjList[cur]) {
-            if (dist[cur] + flight.distance < dist[flight.destination]) {
-                dist[flight.destination] = dist[cur] + flight.distance;
-                prev[flight.destination] = cur;
-                stops[flight.destination] = curStops + 1;
-                q.push({flight.destination, curStops + 1});
+    uint32_t round = 0;
+    while (round < rounds && !frontier.empty()) {
+        ++round;
+        nextFrontier.clear();
+        for (uint32_t cur : frontier) {
+            int base = prevDist[cur].dist;
+            for (uint32_t e = csr.offsets[cur]; e < csr.offsets[cur + 1]; ++e) {
+                uint32_t next = csr.targets[e];
+                if (base + weights[e] < dist[next].dist) {
+                    dist.at(next).dist = base + weights[e];
+                    uint32_t& last = lastImprovement.at(next);
+                    if (last != INVALID_AIRPORT && improvements[last].round == round) {
+                        improvements[last].edge = e;
+                    } else {
+                        improvements.push_back({round, e, last});
+                        last = static_cast<uint32_t>(improvements.size() - 1);
+                    }
+                    if (queuedRound[next] != round) {
+                        queuedRound.at(next) = round;
+                        nextFrontier.push_back(next);
+                    }
+                }
             }
         }
+        for (uint32_t v : nextFrontier) {
+            prevDist.at(v).dist = dist[v].dist;
+        }
+        frontier.swap(nextFrontier);
     }
 
-    Path path;
-    if (dist[dest] == numeric_limits<int>::max()) {
-        return path;
+    if (dist[target].dist == UNREACHED) {
+        return Path();
     }
 
-    for (string at = dest; !at.empty(); at = prev[at]) {
-        path.air_code.push_back(at);
-        if (at == origin) break;
+    // Walk back taking each airport's newest improvement from a round before
+    // the one already used, which skips rounds where it was not improved
+    vector<uint32_t> edges;
+    uint32_t at = target;
+    uint32_t limit = round;
+    while (true) {
+        uint32_t i = lastImprovement[at];
+        while (i != INVALID_AIRPORT && improvements[i].round > limit) {
+            i = improvements[i].next;
+        }
+        if (i == INVALID_AIRPORT) break;
+        edges.push_back(improvements[i].edge);
+        limit = improvements[i].round - 1;
+        at = csr.edgeSource(improvements[i].edge);
     }
-    
-    reverse(path.air_code.begin(), path.air_code.end());
-    
-    for (size_t i = 1; i < path.air_code.size(); ++i) {
-        string from = path.air_code[i-1];
-        string to = path.air_code[i];
-        for (const auto& flight : adjList[from]) {
-            if (flight.destination == to) {
-                path.totalDistance += flight.distance;
-                path.totalCost += flight.cost;
-                break;
+    reverse(edges.begin(), edges.end());
+    return edgePath(src, edges);
+}
+
+vector<Path> airlineGraph::batchQuery(const vector<RouteQuery>& queries, ThreadPool& pool) {
+    // Freeze up front; from here on workers only read the CSR and tables
+    ensureFrozen();
+    vector<Path> results(queries.size());
+
+    auto runRange = [this, &queries, &results](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const RouteQuery& query = queries[i];
+            uint32_t src = getIndex(query.origin);
+            uint32_t target = getIndex(query.dest);
+            if (src == INVALID_AIRPORT || target == INVALID_AIRPORT) continue;
+            if (query.maxStops >= 0) {
+                results[i] = searchPathWithStops(src, target, query.maxStops, query.useCost);
+            } else {
+                results[i] = searchPath(src, target, RouteMetric::of(query.useCost));
             }
         }
+    };
+
+    // A few chunks per worker leaves room for stealing when query costs vary
+    size_t chunk = max<size_t>(1, queries.size() / (static_cast<size_t>(pool.size()) * 8));
+    for (size_t begin = 0; begin < queries.size(); begin += chunk) {
+        size_t end = min(queries.size(), begin + chunk);
+        pool.submit([runRange, begin, end]() { runRange(begin, end); });
     }
-    
-    return path;
+    pool.wait();
+    return results;
 }
 
-vector<Connections> airlineGraph::countConnections() {
-    vector<Connections> results;
-    
-    for (const auto& airport : airportToState) {
-        Connections conn;
-        conn.air_code = airport.first;
-        conn.out = adjList[airport.first].size();
-        
-        for (const auto& other : adjList) {
-            for (const auto& flight : other.second) {
-                if (flight.destination == airport.first) {
-                    conn.in++;
+vector<Path> airlineGraph::batchQuery(const vector<RouteQuery>& queries, unsigned threads) {
+    ThreadPool pool(threads);
+    return batchQuery(queries, pool);
+}
+
+vector<Path> airlineGraph::paretoPaths(const string& origin, const string& dest, size_t maxFrontier) {
+    vector<Path> paths;
+    uint32_t src = getIndex(origin);
+    uint32_t target = getIndex(dest);
+    if (src == INVALID_AIRPORT || target == INVALID_AIRPORT) {
+        return paths;
+    }
+    ensureFrozen();
+    if (!mayReach(src, target)) {
+        return paths;
+    }
+
+    struct Label {
+        int distance, cost;
+        uint32_t node, parent;
+    };
+    vector<Label> labels;
+    // Ordered lexicographically by (distance, cost), stored as label indices
+    auto worse = [&labels](uint32_t a, uint32_t b) {
+        if (labels[a].distance != labels[b].distance) return labels[a].distance > labels[b].distance;
+        return labels[a].cost > labels[b].cost;
+    };
+    priority_queue<uint32_t, vector<uint32_t>, decltype(worse)> pq(worse);
+
+    // Labels settle in (distance, cost) order, so a label is dominated exactly
+    // when an earlier settled label at the same airport is no more expensive
+    SearchWorkspace& workspace = SearchWorkspace::local();
+    StampedArray<SearchLabel>& minCost = workspace.labels[1];  // dist holds the cost
+    StampedArray<uint32_t>& settled = workspace.tally;
+    minCost.reset(csr.nodeCount(), {UNREACHED, INVALID_AIRPORT});
+    settled.reset(csr.nodeCount(), 0);
+    vector<uint32_t> frontier;
+
+    // Under a cap, labels past the first few at an airport are dropped, which
+    // would lose the cheap routes that settle last. Every airport therefore
+    // also keeps the first label matching its cheapest cost from src: those
+    // labels chain into the cheapest route, just as the first labels chain
+    // into the shortest. Costs beyond the cheapest at dest cannot matter.
+    size_t keep = max<size_t>(maxFrontier, 2);
+    StampedArray<SearchLabel>& cheapest = workspace.labels[0];
+    if (maxFrontier > 0) {
+        cheapest.reset(csr.nodeCount(), {UNREACHED, INVALID_AIRPORT});
+        MinHeapBuffer& heap = workspace.heap[0];
+        heap.reset(0);
+        cheapest.at(src).dist = 0;
+        heap.push({0, src});
+        while (!heap.empty()) {
+            int cost = heap.top().first;
+            uint32_t cur = heap.top().second;
+            heap.pop();
+            if (cost > cheapest[cur].dist) continue;
+            if (cost > cheapest[target].dist) break;
+            for (uint32_t e = csr.offsets[cur]; e < csr.offsets[cur + 1]; ++e) {
+                uint32_t next = csr.targets[e];
+                if (cost + csr.costs[e] < cheapest[next].dist) {
+                    cheapest.at(next).dist = cost + csr.costs[e];
+                    heap.push({cost + csr.costs[e], next});
                 }
             }
         }
-        
-        results.push_back(conn);
     }
-    
-    sort(results.begin(), results.end(), 
-        [](const Connections& a, const Connections& b) {
-            return a.totalConnections() > b.totalConnections();
-        });
-    
+
+    labels.push_back({0, 0, src, INVALID_AIRPORT});
+    pq.push(0);
+
+    while (!pq.empty()) {
+        uint32_t id = pq.top();
+        pq.pop();
+        Label label = labels[id];
+
+        if (label.cost >= minCost[label.node].dist) continue;
+        if (maxFrontier > 0 && label.node != target && settled[label.node] >= keep - 1 &&
+            label.cost != cheapest[label.node].dist) {
+            continue;
+        }
+        minCost.at(label.node).dist = label.cost;
+        settled.at(label.node)++;
+
+        if (label.node == target) {
+            frontier.push_back(id);
+            continue;
+        }
+
+        for (uint32_t e = csr.offsets[label.node]; e < csr.offsets[label.node + 1]; ++e) {
+            uint32_t next = csr.targets[e];
+            int cost = label.cost + csr.costs[e];
+            // Anything no cheaper than a settled route to next or to dest is dominated
+            if (cost >= minCost[next].dist || cost >= minCost[target].dist) continue;
+            labels.push_back({label.distance + csr.distances[e], cost, next, id});
+            pq.push(static_cast<uint32_t>(labels.size() - 1));
+        }
+    }
+
+    // Thin the routes at dest evenly, from the shortest to the cheapest
+    if (maxFrontier > 0 && frontier.size() > keep) {
+        vector<uint32_t> thinned(keep);
+        for (size_t i = 0; i < keep; ++i) {
+            thinned[i] = frontier[(i * (frontier.size() - 1) + (keep - 1) / 2) / (keep - 1)];
+        }
+        frontier.swap(thinned);
+    }
+
+    for (uint32_t id : frontier) {
+        Path path;
+        path.totalDistance = labels[id].distance;
+        path.totalCost = labels[id].cost;
+        for (uint32_t at = id; at != INVALID_AIRPORT; at = labels[at].parent) {
+            path.air_code.push_back(airportCodes[labels[at].node]);
+        }
+        reverse(path.air_code.begin(), path.air_code.end());
+        paths.push_back(path);
+    }
+    return paths;
+}
+
+void airlineGraph::rebuildDegrees() {
+    inDegree.assign(airportCount(), 0);
+    outDegree.assign(airportCount(), 0);
+    for (const auto& flight : flights) {
+        outDegree[flight.origin]++;
+        inDegree[flight.destination]++;
+    }
+}
+
+vector<Connections> airlineGraph::countConnections() {
+    return topHubs(airportCount());
+}
+
+vector<Connections> airlineGraph::topHubs(size_t k) {
+    vector<uint32_t> ids(airportCount());
+    for (uint32_t id = 0; id < ids.size(); ++id) {
+        ids[id] = id;
+    }
+    k = min(k, ids.size());
+
+    // Busiest first, ties broken by id so the ranking is stable
+    auto busier = [this](uint32_t a, uint32_t b) {
+        uint32_t totalA = inDegree[a] + outDegree[a];
+        uint32_t totalB = inDegree[b] + outDegree[b];
+        return totalA != totalB ? totalA > totalB : a < b;
+    };
+    if (k < ids.size()) {
+        nth_element(ids.begin(), ids.begin() + k, ids.end(), busier);
+    }
+    sort(ids.begin(), ids.begin() + k, busier);
+
+    vector<Connections> results(k);
+    for (size_t i = 0; i < k; ++i) {
+        results[i].air_code = airportCodes[ids[i]];
+        results[i].in = inDegree[ids[i]];
+        results[i].out = outDegree[ids[i]];
+    }
     return results;
 }
 
 void airlineGraph::createUndirectedGraph() {
+    ensureFrozen();
     undirectedEdges.clear();
-    unordered_map<string, unordered_map<string, int>> edgeCosts;
     
-    for (const auto& from : adjList) {
-        for (const auto& flight : from.second) {
-            string u = min(from.first, flight.destination);
-            string v = max(from.first, flight.destination);
-            edgeCosts[u][v] = min(edgeCosts[u][v] == 0 ? numeric_limits<int>::max() : edgeCosts[u][v], 
-                                flight.cost);
+    for (uint32_t from = 0; from < csr.nodeCount(); ++from) {
+        for (uint32_t e = csr.offsets[from]; e < csr.offsets[from + 1]; ++e) {
+            uint32_t to = csr.targets[e];
+            if (from == to) continue;
+            undirectedEdges.emplace_back(min(from, to), max(from, to), csr.costs[e]);
         }
     }
     
-    for (const auto& u : edgeCosts) {
-        for (const auto& v : u.second) {
-            undirectedEdges.emplace_back(u.first, v.first, v.second);
-        }
+    // Keep only the cheapest flight between each unordered pair of airports
+    sort(undirectedEdges.begin(), undirectedEdges.end(),
+         [](const UndirectedEdge& a, const UndirectedEdge& b) {
+             if (a.u != b.u) return a.u < b.u;
+             if (a.v != b.v) return a.v < b.v;
+             return a.cost < b.cost;
+         });
+    undirectedEdges.erase(unique(undirectedEdges.begin(), undirectedEdges.end(),
+                                 [](const UndirectedEdge& a, const UndirectedEdge& b) {
+                                     return a.u == b.u && a.v == b.v;
+                                 }),
+                          undirectedEdges.end());
+
+    // Symmetric adjacency over the deduplicated edges, one entry per endpoint
+    uint32_t n = csr.nodeCount();
+    undirectedAdj.offsets.assign(n + 1, 0);
+    for (const auto& edge : undirectedEdges) {
+        undirectedAdj.offsets[edge.u + 1]++;
+        undirectedAdj.offsets[edge.v + 1]++;
+    }
+    for (uint32_t i = 0; i < n; ++i) {
+        undirectedAdj.offsets[i + 1] += undirectedAdj.offsets[i];
+    }
+    undirectedAdj.neighbors.resize(undirectedEdges.size() * 2);
+    undirectedAdj.costs.resize(undirectedEdges.size() * 2);
+    vector<uint32_t> cursor(undirectedAdj.offsets.begin(), undirectedAdj.offsets.end() - 1);
+    for (const auto& edge : undirectedEdges) {
+        uint32_t slot = cursor[edge.u]++;
+        undirectedAdj.neighbors[slot] = edge.v;
+        undirectedAdj.costs[slot] = edge.cost;
+        slot = cursor[edge.v]++;
+        undirectedAdj.neighbors[slot] = edge.u;
+        undirectedAdj.costs[slot] = edge.cost;
     }
 }
 
@@ -341,48 +1081,35 @@ pair<vector<mstEdge>, int> airlineGraph::primMST() {
         return {mst, totalCost};
     }
     
-    unordered_map<string, int> key;
-    unordered_map<string, string> parent;
-    unordered_map<string, bool> inMST;
-    priority_queue<pair<int, string>, vector<pair<int, string>>, greater<pair<int, string>>> pq;
+    uint32_t n = csr.nodeCount();
+    vector<uint32_t> parent(n, INVALID_AIRPORT);
+    vector<bool> inMST(n, false);
+    IndexedHeap<4> pq(n);
     
-    for (const auto& airport : airportToState) {
-        key[airport.first] = numeric_limits<int>::max();
-        inMST[airport.first] = false;
-    }
-    
-    string start = airportToState.begin()->first;
-    key[start] = 0;
-    pq.push({0, start});
+    uint32_t start = 0;
+    pq.pushOrDecrease(start, 0);
     
     while (!pq.empty()) {
-        string u = pq.top().second;
-        pq.pop();
-        
-        if (inMST[u]) continue;
+        pair<int, uint32_t> top = pq.pop();
+        uint32_t u = top.second;
         inMST[u] = true;
         
-        if (!parent[u].empty()) {
-            mst.emplace_back(parent[u], u, key[u]);
-            totalCost += key[u];
+        if (parent[u] != INVALID_AIRPORT) {
+            mst.emplace_back(airportCodes[parent[u]], airportCodes[u], top.first);
+            totalCost += top.first;
         }
         
-        for (const auto& edge : undirectedEdges) {
-            string v = (edge.from == u) ? edge.to : (edge.to == u ? edge.from : "");
-            if (!v.empty() && !inMST[v] && edge.cost < key[v]) {
-                key[v] = edge.cost;
-                parent[v] = u;
-                pq.push({key[v], v});
-            }
+        for (uint32_t i = undirectedAdj.offsets[u]; i < undirectedAdj.offsets[u + 1]; ++i) {
+            uint32_t v = undirectedAdj.neighbors[i];
+            int cost = undirectedAdj.costs[i];
+            if (inMST[v] || (pq.contains(v) && cost >= pq.key(v))) continue;
+            pq.pushOrDecrease(v, cost);
+            parent[v] = u;
         }
     }
     
-    // Check if all vertices are included
-    for (const auto& airport : airportToState) {
-        if (!inMST[airport.first]) {
-            cout << "Graph is disconnected. MST cannot be formed for all vertices." << endl;
-            break;
-        }
+    if (components.weakCount > 1) {
+        cout << "Graph is disconnected. MST cannot be formed for all vertices." << endl;
     }
     
     return {mst, totalCost};
@@ -391,40 +1118,145 @@ pair<vector<mstEdge>, int> airlineGraph::primMST() {
 pair<vector<mstEdge>, int> airlineGraph::kruskalMST() {
     createUndirectedGraph();
     sort(undirectedEdges.begin(), undirectedEdges.end(),
-         [](const mstEdge& a, const mstEdge& b) { return a.cost < b.cost; });
+         [](const UndirectedEdge& a, const UndirectedEdge& b) { return a.cost < b.cost; });
     
     vector<mstEdge> mst;
     int totalCost = 0;
     
-    DisjointSet ds(airportToState.size());
-    unordered_map<string, int> indexMap;
-    int index = 0;
-    for (const auto& airport : airportToState) {
-        indexMap[airport.first] = index++;
-    }
+    uint32_t n = airportCount();
+    DisjointSet ds(n);
     
     for (const auto& edge : undirectedEdges) {
-        int u = indexMap[edge.from];
-        int v = indexMap[edge.to];
-        if (ds.find(u) != ds.find(v)) {
-            ds.unionSet(u, v);
-            mst.push_back(edge);
+        if (ds.find(edge.u) != ds.find(edge.v)) {
+            ds.unionSet(edge.u, edge.v);
+            mst.emplace_back(airportCodes[edge.u], airportCodes[edge.v], edge.cost);
             totalCost += edge.cost;
         }
     }
     
-    // Check for disconnected components
-    int root = ds.find(0);
-    bool disconnected = false;
-    for (int i = 1; i < airportToState.size(); ++i) {
-        if (ds.find(i) != root) {
-            disconnected = true;
-            break;
+    if (components.weakCount > 1) {
+        cout << "Graph is disconnected. Returning minimum spanning forest." << endl;
+    }
+    
+    return {mst, totalCost};
+}
+
+pair<vector<mstEdge>, int> airlineGraph::boruvkaMST(unsigned threads, vector<pair<vector<mstEdge>, int>>* forests) {
+    createUndirectedGraph();
+    uint32_t n = airportCount();
+    vector<UndirectedEdge> edges = undirectedEdges;
+    ThreadPool pool(threads);
+    
+    // Each chunk owns a fixed slice of edges and compacts its live ones to the front
+    size_t chunkCount = max<size_t>(1, min<size_t>(edges.size(), pool.size() * 4));
+    size_t chunkSize = (edges.size() + chunkCount - 1) / max<size_t>(1, chunkCount);
+    vector<size_t> chunkBegin(chunkCount), chunkLive(chunkCount);
+    for (size_t c = 0; c < chunkCount; ++c) {
+        chunkBegin[c] = min(edges.size(), c * chunkSize);
+        chunkLive[c] = min(edges.size(), chunkBegin[c] + chunkSize) - chunkBegin[c];
+    }
+    
+    // Cheapest edge leaving each component, packed as (cost << 32 | edge slot) so
+    // ties break by slot and every component agrees on one total order
+    const uint64_t NO_EDGE = UINT64_MAX;
+    vector<atomic<uint64_t>> best(n);
+    vector<uint32_t> comp(n);
+    ConcurrentDisjointSet ds(n);
+    vector<mstEdge> mst;
+    vector<uint32_t> mstAirport;  // one endpoint id per mst edge
+    int totalCost = 0;
+    
+    // Airports are likewise split into ranges for the per-round vertex passes
+    size_t rangeCount = max<size_t>(1, min<size_t>(n, pool.size() * 4));
+    size_t rangeSize = (n + rangeCount - 1) / rangeCount;
+    vector<vector<uint32_t>> chosen(rangeCount);  // edge slots merged by each range
+    auto forEachRange = [&](auto body) {
+        for (size_t r = 0; r < rangeCount; ++r) {
+            uint32_t begin = static_cast<uint32_t>(min<size_t>(n, r * rangeSize));
+            uint32_t end = static_cast<uint32_t>(min<size_t>(n, begin + rangeSize));
+            pool.submit([&body, r, begin, end]() { body(r, begin, end); });
+        }
+        pool.wait();
+    };
+    
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        forEachRange([&](size_t, uint32_t begin, uint32_t end) {
+            for (uint32_t v = begin; v < end; ++v) {
+                comp[v] = ds.find(v);
+                best[v].store(NO_EDGE, memory_order_relaxed);
+            }
+        });
+        
+        for (size_t c = 0; c < chunkCount; ++c) {
+            pool.submit([&, c]() {
+                size_t begin = chunkBegin[c];
+                size_t kept = begin;
+                for (size_t i = begin; i < begin + chunkLive[c]; ++i) {
+                    const UndirectedEdge& edge = edges[i];
+                    uint32_t cu = comp[edge.u], cv = comp[edge.v];
+                    if (cu == cv) continue;  // already inside one tree, drop for good
+                    edges[kept] = edge;
+                    uint64_t packed = (static_cast<uint64_t>(edge.cost) << 32) | kept;
+                    kept++;
+                    for (uint32_t root : {cu, cv}) {
+                        uint64_t seen = best[root].load(memory_order_relaxed);
+                        while (packed < seen && !best[root].compare_exchange_weak(seen, packed, memory_order_relaxed)) {
+                        }
+                    }
+                }
+                chunkLive[c] = kept - begin;
+            });
+        }
+        pool.wait();
+        
+        // Under a strict edge order the winners form a forest. An edge won by both
+        // of its components is merged once, by the lower-numbered one.
+        forEachRange([&](size_t r, uint32_t begin, uint32_t end) {
+            chosen[r].clear();
+            for (uint32_t root = begin; root < end; ++root) {
+                uint64_t packed = best[root].load(memory_order_relaxed);
+                if (packed == NO_EDGE) continue;
+                uint32_t slot = static_cast<uint32_t>(packed);
+                const UndirectedEdge& edge = edges[slot];
+                uint32_t other = comp[edge.u] == root ? comp[edge.v] : comp[edge.u];
+                if (other < root && best[other].load(memory_order_relaxed) == packed) continue;
+                if (ds.unite(edge.u, edge.v)) {
+                    chosen[r].push_back(slot);
+                }
+            }
+        });
+        for (const auto& slots : chosen) {
+            for (uint32_t slot : slots) {
+                const UndirectedEdge& edge = edges[slot];
+                mst.emplace_back(airportCodes[edge.u], airportCodes[edge.v], edge.cost);
+                mstAirport.push_back(edge.u);
+                totalCost += edge.cost;
+                merged = true;
+            }
         }
     }
-    if (disconnected) {
-        cout << "Graph is disconnected. Returning minimum spanning forest." << endl;
+    
+    // Group the forest by component, in order of each component's first airport
+    vector<uint32_t> componentOf(n, INVALID_AIRPORT);
+    uint32_t componentCount = 0;
+    for (uint32_t v = 0; v < n; ++v) {
+        uint32_t root = ds.find(v);
+        if (componentOf[root] == INVALID_AIRPORT) componentOf[root] = componentCount++;
+    }
+    if (componentCount > 1) {
+        cout << "Graph is disconnected. Returning minimum spanning forest over "
+             << componentCount << " components." << endl;
+    }
+    if (forests) {
+        forests->assign(componentCount, {vector<mstEdge>(), 0});
+        for (size_t i = 0; i < mst.size(); ++i) {
+            auto& forest = (*forests)[componentOf[ds.find(mstAirport[i])]];
+            forest.first.push_back(mst[i]);
+            forest.second += mst[i].cost;
+        }
     }
     
     return {mst, totalCost};
-}
\ No newline at end of file
+}
@@ -5,14 +5,94 @@
 #include <vector>
 #include <unordered_map>
 #include <queue>
+#include <cstdint>
+#include <limits>
+#include "FloydWarshall.h"
+#include "ThreadPool.h"
+#include "DisjointSet.h"
+#include "ContractionHierarchy.h"
+#include "ClockCache.h"
+#include "SearchWorkspace.h"
+#include "WeightPolicy.h"
+#include "Timetable.h"
+
+// Sentinel for "no airport" wherever an interned airport id is expected
+const uint32_t INVALID_AIRPORT = UINT32_MAX;
 
 struct Flight {
-    std::string destination;
+    uint32_t origin, destination;
     int distance, cost;
     
     Flight() {}
-    Flight(const std::string& dest, int dist, int cost)
-        : destination(dest), distance(dist), cost(cost) {}
+    Flight(uint32_t from, uint32_t dest, int dist, int cost)
+        : origin(from), destination(dest), distance(dist), cost(cost) {}
+};
+
+// Frozen compressed-sparse-row view of the flight network. The outgoing
+// flights of airport u occupy [offsets[u], offsets[u + 1]) of the edge arrays.
+struct CSRGraph {
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> targets;
+    std::vector<int> distances;
+    std::vector<int> costs;
+    
+    uint32_t nodeCount() const {
+        return offsets.empty() ? 0 : static_cast<uint32_t>(offsets.size() - 1);
+    }
+    uint32_t edgeCount() const {
+        return static_cast<uint32_t>(targets.size());
+    }
+    uint32_t edgeSource(uint32_t edge) const;
+};
+
+// Dense all-pairs table for one metric. Entry (u, v) lives at u * n + v;
+// nextEdge holds the first flight of a shortest u -> v route.
+struct AllPairsTable {
+    uint32_t n;
+    std::vector<int> dist;
+    std::vector<uint32_t> nextEdge;
+    
+    AllPairsTable() : n(0) {}
+    
+    bool ready() const { return n != 0; }
+};
+
+// Point-to-point strategies for dijkstraPath. AStar uses great-circle bounds for
+// distance when every airport has coordinates and ALT landmark bounds otherwise.
+// Hierarchy answers from a Contraction Hierarchy of the chosen metric. Dynamic
+// answers from a full tree cached per recent origin that updateFlightEdge and
+// removeFlightEdge repair in place instead of discarding.
+enum class SearchMode { Dijkstra, Bidirectional, AStar, Hierarchy, Dynamic };
+
+// ALT lower bounds: shortest distances from and to a few landmark airports for
+// each metric, stored per airport as [v * landmarks.size() + l]
+struct LandmarkTable {
+    std::vector<uint32_t> landmarks;
+    std::vector<int> fromLandmark[2];  // indexed by useCost
+    std::vector<int> toLandmark[2];
+    
+    bool ready() const { return !landmarks.empty(); }
+};
+
+// Connectivity summary rebuilt whenever the graph is frozen. Strong components
+// are numbered sinks first, so a flight never leads to a higher number.
+struct ComponentIndex {
+    std::vector<uint32_t> scc;         // strong component per airport
+    std::vector<uint32_t> weak;        // weak component per airport
+    uint32_t sccCount, weakCount;
+    std::vector<uint32_t> dagOffsets;  // condensation DAG over strong components
+    std::vector<uint32_t> dagTargets;
+    
+    ComponentIndex() : sccCount(0), weakCount(0) {}
+};
+
+// Single-source shortest-path tree over csr edge ids
+struct ShortestPathTree {
+    std::vector<int> dist;
+    std::vector<uint32_t> prevEdge;
+    uint64_t lastUsed;  // Dynamic mode LRU stamp
+    
+    ShortestPathTree() : lastUsed(0) {}
 };
 
 struct Path {
@@ -23,6 +103,58 @@ struct Path {
     Path() : totalDistance(0), totalCost(0) {}
 };
 
+// A timed route: route.air_code[i] -> route.air_code[i + 1] departs at
+// departures[i] and lands at arrivals[i], in minutes after midnight of the
+// service day. An empty route means no journey.
+struct Journey {
+    Path route;
+    std::vector<int> departures, arrivals;
+    
+    bool empty() const { return route.air_code.empty(); }
+};
+
+// One entry of a batch request; maxStops < 0 means no stop limit
+struct RouteQuery {
+    std::string origin, dest;
+    bool useCost;
+    int maxStops;
+    
+    RouteQuery() : useCost(false), maxStops(-1) {}
+    RouteQuery(const std::string& from, const std::string& to, bool cost = false, int stops = -1)
+        : origin(from), dest(to), useCost(cost), maxStops(stops) {}
+};
+
+// Key of one cached query result. dest is unused by state queries, state by
+// the others, and maxStops by all but stop-limited routes.
+struct QueryKey {
+    enum Kind : uint8_t { Route, State, Stops };
+    Kind kind;
+    RouteMetric metric;
+    int maxStops;
+    uint32_t origin, dest;
+    std::string state;
+    
+    QueryKey(Kind k, uint32_t from, uint32_t to, const RouteMetric& m, int stops = -1,
+             const std::string& st = std::string())
+        : kind(k), metric(m), maxStops(stops), origin(from), dest(to), state(st) {}
+    
+    bool operator==(const QueryKey& other) const {
+        return kind == other.kind && metric == other.metric && maxStops == other.maxStops &&
+               origin == other.origin && dest == other.dest && state == other.state;
+    }
+};
+
+struct QueryKeyHash {
+    size_t operator()(const QueryKey& key) const {
+        uint64_t h = (static_cast<uint64_t>(key.origin) << 32 | key.dest) * 0x9E3779B97F4A7C15ULL;
+        h ^= static_cast<uint64_t>(key.kind) << 40 ^ static_cast<uint64_t>(key.metric.kind) << 48 ^
+             static_cast<uint32_t>(key.maxStops);
+        h = (h ^ static_cast<uint32_t>(key.metric.distanceWeight)) * 0x100000001B3ULL ^
+            static_cast<uint32_t>(key.metric.costWeight);
+        return static_cast<size_t>(h ^ std::hash<std::string>()(key.state));
+    }
+};
+
 struct mstEdge {
     std::string from, to;
     int cost;
@@ -32,6 +164,34 @@ struct mstEdge {
         : from(f), to(t), cost(cst) {}
 };
 
+struct UndirectedEdge {
+    uint32_t u, v;
+    int cost;
+    
+    UndirectedEdge() {}
+    UndirectedEdge(uint32_t a, uint32_t b, int cst) : u(a), v(b), cost(cst) {}
+};
+
+// Symmetric adjacency built from undirectedEdges: both endpoints list each edge
+struct UndirectedAdjacency {
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> neighbors;
+    std::vector<int> costs;
+};
+
+// Brandes centrality of one airport. Betweenness counts, over ordered pairs
+// of other airports, the share of their shortest routes that stop here;
+// closeness is Wasserman-Faust closeness from the airports that reach it.
+struct Centrality {
+    std::string air_code;
+    double betweenness;
+    double closeness;
+    
+    Centrality() : betweenness(0), closeness(0) {}
+};
+
+struct BrandesScratch;  // per-thread search arrays, see Centrality.cpp
+
 struct Connections {
     std::string air_code;
     int in, out;
@@ -43,41 +203,214 @@ struct Connections {
     }
 };
 
-class DisjointSet {
-    std::vector<int> parent, rank;
-public:
-    DisjointSet(int size);
-    int find(int v);
-    void unionSet(int u, int v);
-};
-
 class airlineGraph {
 private:
-    std::unordered_map<std::string, std::vector<Flight>> adjList;
-    std::unordered_map<std::string, std::string> airportToState;
-    std::vector<mstEdge> undirectedEdges;
+    std::vector<std::string> airportCodes;                 // id -> IATA code
+    std::vector<std::string> airportStates;                // id -> state code
+    std::vector<double> airportLat, airportLon;            // degrees, NaN when unknown
+    std::unordered_map<std::string, uint32_t> airportIds;  // IATA code -> id
+    std::vector<Flight> flights;                           // edge list; flights[e] is csr edge e once frozen
+    std::vector<uint32_t> inDegree, outDegree;             // kept current by appendFlight
+    CSRGraph csr;
+    CSRGraph reverseCsr;                                   // incoming flights per airport
+    std::vector<uint32_t> reverseEdge;                     // reverseCsr slot -> csr edge
+    bool csrDirty;
+    AllPairsTable allPairs[2];                             // indexed by useCost
+    ComponentIndex components;
+    LandmarkTable landmarkTable;
+    ContractionHierarchy hierarchies[2];                   // indexed by useCost
+    std::unordered_map<uint32_t, ShortestPathTree> dynamicTrees[2];  // per metric, keyed by origin
+    size_t dynamicTreeLimit;                               // most trees kept per metric
+    uint64_t dynamicClock;                                 // source of lastUsed stamps
+    double geoScale;                                       // great-circle miles -> admissible distance
+    bool allLocated;
+    int maxWeight[2];                                      // largest distance and cost, sizes Dial buckets
+    QueueKind dijkstraQueue, bidirectionalQueue;
+    uint64_t graphVersion;                                 // bumped by every change to the graph
+    ClockCache<QueryKey, std::vector<Path>, QueryKeyHash> queryCache;
+    Timetable timetable;                                   // scheduled flights, sorted on first query
+    std::vector<UndirectedEdge> undirectedEdges;
+    UndirectedAdjacency undirectedAdj;
     
-    bool airportExists(const std::string& air_code) const;
-    std::vector<std::string> getAllAirports() const;
-    int getIndex(const std::string& air_code) const;
+    uint32_t internAirport(const std::string& air_code);
+    void appendFlight(uint32_t from, uint32_t to, int dist, int cost);
+    void rebuildDegrees();  // one O(V + E) pass over flights, for bulk loads
+    void ensureFrozen();
+    void onGraphFrozen();  // refreshes everything derived from csr
+    void resetWeightTables();  // drops tables that depend on flight weights
+    void buildComponentIndex();
+    void buildReverseGraph();
+    void calibrateGeoBound();
+    // O(1) filter: false means dest is certainly unreachable from src
+    bool mayReach(uint32_t src, uint32_t target) const;
+    // Route over the given csr edges, which must form a chain from origin
+    Path edgePath(uint32_t origin, const std::vector<uint32_t>& edges) const;
+    Path buildPath(uint32_t origin, uint32_t dest, const std::vector<uint32_t>& prevEdge) const;
+    Path buildPath(uint32_t origin, uint32_t dest, const StampedArray<SearchLabel>& labels) const;
+    // Dijkstra from src that stops once every airport in targets is settled;
+    // an empty target list builds the full tree
+    void shortestPathTree(uint32_t src, const RouteMetric& metric, const std::vector<uint32_t>& targets,
+                          std::vector<int>& dist, std::vector<uint32_t>& prevEdge) const;
+    template <class Weight, class Queue>
+    void growTree(uint32_t src, Weight weight, Queue& pq, const std::vector<uint32_t>& targets,
+                  std::vector<int>& dist, std::vector<uint32_t>& prevEdge) const;
+    Path tablePath(const AllPairsTable& table, uint32_t origin, uint32_t dest) const;
+    // Read-only search cores; callers must have frozen the graph first
+    // Metrics other than distance and cost run every mode but Bidirectional as Dijkstra
+    Path searchPath(uint32_t src, uint32_t target, const RouteMetric& metric,
+                    SearchMode mode = SearchMode::Dijkstra) const;
+    template <class Weight, class Queue>
+    Path pointSearch(uint32_t src, uint32_t target, Weight weight, Queue& pq) const;
+    Path bidirectionalPath(uint32_t src, uint32_t target, const RouteMetric& metric) const;
+    template <class Weight, class Queue>
+    Path bidirectionalSearch(uint32_t src, uint32_t target, Weight weight, Queue& pqF, Queue& pqB) const;
+    Path aStarPath(uint32_t src, uint32_t target, bool useCost) const;
+    Path hierarchyPath(uint32_t src, uint32_t target, bool useCost) const;
+    // First csr edge from -> to, or INVALID_AIRPORT
+    uint32_t findFlight(uint32_t from, uint32_t to) const;
+    // Incremental tree repair after one flight got cheaper, or after the tree
+    // flight into root got dearer or disappeared
+    void repairDecrease(ShortestPathTree& tree, uint32_t edge, bool useCost) const;
+    void repairIncrease(ShortestPathTree& tree, uint32_t root, bool useCost) const;
+    // Drops least recently used Dynamic mode trees until at most keep remain
+    void trimDynamicTrees(bool useCost, size_t keep);
+    double greatCircleMiles(uint32_t a, uint32_t b) const;
+    Path searchPathWithStops(uint32_t src, uint32_t target, int maxStops, bool useCost) const;
+    void appendScheduledFlight(uint32_t from, uint32_t to, int departure, int arrival, int dist, int cost);
+    Journey buildJourney(uint32_t origin, const std::vector<uint32_t>& connections) const;
+    // Brandes from each source, in parallel; sums dependencies, distances and
+    // reach counts per airport, each source weighted by scale
+    std::vector<Centrality> brandesCentrality(const std::vector<uint32_t>& sources, double scale,
+                                              const RouteMetric& metric, unsigned threads) const;
+    template <class Weight, class Queue>
+    void brandesSource(uint32_t src, Weight weight, Queue& pq, BrandesScratch& scratch) const;
 
 public:
-    airlineGraph() {}
+    airlineGraph() : csrDirty(false), dynamicTreeLimit(64), dynamicClock(0), geoScale(0), allLocated(false),
+                     maxWeight{0, 0},
+                     dijkstraQueue(QueueKind::Dial), bidirectionalQueue(QueueKind::Dial),
+                     graphVersion(0), queryCache(1024) {}
     
-    void addAirportNode(const std::string& air_code, const std::string& state_code);
+    uint32_t addAirportNode(const std::string& air_code, const std::string& state_code);
+    void setAirportLocation(const std::string& air_code, double lat, double lon);
     void addFlightEdge(const std::string& origin, const std::string& dest, int dist, int cost);
-    Path dijkstraPath(const std::string& origin, const std::string& dest, bool useCost = false);
-    std::vector<Path> shortestPathsToState(const std::string& origin, const std::string& state, bool useCost = false);
-    Path shortestPathWithStops(const std::string& origin, const std::string& dest, int maxStops);
+    // Change or drop the first flight origin -> dest; false if there is none.
+    // Updates patch the frozen graph in place, removals refreeze it, and both
+    // repair the Dynamic mode trees rather than recomputing them.
+    bool updateFlightEdge(const std::string& origin, const std::string& dest, int dist, int cost);
+    bool removeFlightEdge(const std::string& origin, const std::string& dest);
+    // Most Dynamic mode trees kept per metric, 64 by default. Each holds O(V)
+    // labels and every update repairs them all, so the least recently queried
+    // origin is dropped first; 0 answers Dynamic queries with plain Dijkstra.
+    void setDynamicTreeCapacity(size_t trees);
+    size_t dynamicTreeCount() const { return dynamicTrees[0].size() + dynamicTrees[1].size(); }
+    // A flight that departs and arrives at fixed minutes after midnight of the
+    // service day; arrival must be later than departure (past 1440 overnight).
+    // It also joins the static network as an ordinary flight; updating or
+    // removing that flight leaves the schedule as it was. False if the times
+    // are invalid.
+    bool addScheduledFlight(const std::string& origin, const std::string& dest, int departure, int arrival,
+                            int dist, int cost);
+    // Minimum minutes between landing at an airport and the next departure
+    // from it; airports without their own value use the default of 30
+    bool setMinConnectionTime(const std::string& air_code, int minutes);
+    bool setDefaultMinConnectionTime(int minutes);
+    void freeze();
+    // Fills distance and cost all-pairs tables (threads == 0 uses every core);
+    // until the graph changes, dijkstraPath and shortestPathsToState read from them
+    void precomputeAllPairs(unsigned threads = 0);
+    // Row-major n*n distances from the tiled Floyd-Warshall kernel, UNREACHED where
+    // unreachable; kernelUsed reports which min-plus loop ran
+    std::vector<int> floydWarshallDistances(bool useCost, MinPlusKernel& kernelUsed,
+                                            MinPlusKernel maxKernel = MinPlusKernel::AVX2);
+    
+    // Code <-> index table, maintained as airports are added
+    uint32_t getIndex(const std::string& air_code) const;
+    const std::string& getAirportCode(uint32_t index) const { return airportCodes[index]; }
+    uint32_t airportCount() const { return static_cast<uint32_t>(airportCodes.size()); }
+    
+    bool hasRoute(const std::string& origin, const std::string& dest);
+    const ComponentIndex& getComponents() { ensureFrozen(); return components; }
+    Path dijkstraPath(const std::string& origin, const std::string& dest, const RouteMetric& metric,
+                      SearchMode mode = SearchMode::Dijkstra);
+    Path dijkstraPath(const std::string& origin, const std::string& dest, bool useCost = false,
+                      SearchMode mode = SearchMode::Dijkstra) {
+        return dijkstraPath(origin, dest, RouteMetric::of(useCost), mode);
+    }
+    // Picks count spread-out landmarks for A*'s ALT bounds; dijkstraPath builds
+    // the default set on the first A* query after each change to the graph
+    void buildLandmarks(unsigned count = 8);
+    // Priority queue for the Dijkstra and Bidirectional engines; Dijkstra's also
+    // serves state queries, all-pairs rows and Dynamic tree builds. Other modes
+    // always use the binary heap, and setting them returns false.
+    bool setQueueKind(SearchMode mode, QueueKind kind);
+    QueueKind getQueueKind(SearchMode mode) const;
+    // Offline Contraction Hierarchy preprocessing for one metric; dijkstraPath
+    // builds it on the first Hierarchy query after each change to the graph
+    void buildContractionHierarchy(bool useCost);
+    std::vector<Path> shortestPathsToState(const std::string& origin, const std::string& state, const RouteMetric& metric);
+    std::vector<Path> shortestPathsToState(const std::string& origin, const std::string& state, bool useCost = false) {
+        return shortestPathsToState(origin, state, RouteMetric::of(useCost));
+    }
+    // Up to k loopless routes in order of weight (Yen's algorithm); routes over
+    // different flights between the same airports count as distinct
+    std::vector<Path> kShortestPaths(const std::string& origin, const std::string& dest, size_t k,
+                                     bool useCost = false);
+    // Cheapest route using at most maxStops flights
+    Path shortestPathWithStops(const std::string& origin, const std::string& dest, int maxStops, bool useCost = false);
+    // Runs the queries in parallel against the frozen graph, results in input order
+    std::vector<Path> batchQuery(const std::vector<RouteQuery>& queries, ThreadPool& pool);
+    std::vector<Path> batchQuery(const std::vector<RouteQuery>& queries, unsigned threads = 0);
+    // Connection Scan over the scheduled flights: the earliest arrival leaving
+    // origin at or after departAfter, and the profile of departures within
+    // [from, until] that no later one in the window arrives as early as
+    Journey earliestArrival(const std::string& origin, const std::string& dest, int departAfter);
+    std::vector<Journey> arrivalProfile(const std::string& origin, const std::string& dest, int from = 0,
+                                        int until = std::numeric_limits<int>::max());
+    // Non-dominated (distance, cost) routes, shortest first. maxFrontier > 0
+    // caps the labels kept per airport and thins the routes returned evenly
+    // along the frontier; the shortest and the cheapest route are always kept,
+    // so a cap below 2 acts as 2
+    std::vector<Path> paretoPaths(const std::string& origin, const std::string& dest, size_t maxFrontier = 0);
+    // Exact betweenness and closeness of every airport in id order, one
+    // shortest-path search per source spread over threads (0 uses every core).
+    // Ties between routes of equal weight share the credit, so flights must
+    // weigh more than zero under the metric.
+    std::vector<Centrality> centrality(const RouteMetric& metric = RouteMetric::distance(), unsigned threads = 0);
+    // Estimate from sampled sources: with probability 1 - delta every
+    // betweenness is within epsilon * n * (n - 2) of exact; closeness comes
+    // from the same sample without a bound. Falls back to centrality() when
+    // the sample would not be smaller than the network.
+    std::vector<Centrality> approximateCentrality(double epsilon, double delta = 0.1,
+                                                  const RouteMetric& metric = RouteMetric::distance(),
+                                                  unsigned threads = 0, uint64_t seed = 1);
     std::vector<Connections> countConnections();
+    // The k busiest airports by in + out flights, busiest first
+    std::vector<Connections> topHubs(size_t k);
+    // dijkstraPath, shortestPathsToState and shortestPathWithStops answer repeat
+    // queries from a CLOCK cache that drops results from older graph versions.
+    // Every search mode is exact, so modes share entries. 0 disables the cache.
+    void setQueryCacheCapacity(size_t entries) { queryCache.setCapacity(entries); }
+    CacheStats getQueryCacheStats() const { return queryCache.stats(); }
+    uint64_t getGraphVersion() const { return graphVersion; }
     void createUndirectedGraph();
-    void readCSV(const std::string& filename);
+    // Appends the flights in filename and refreezes; false if it cannot be opened
+    bool readCSV(const std::string& filename);
+    // Versioned, checksummed binary image of the frozen graph (see GraphSnapshot.cpp);
+    // loading replaces the current graph and returns false if the file is unusable
+    bool writeSnapshot(const std::string& filename);
+    bool loadSnapshot(const std::string& filename);
     
     std::pair<std::vector<mstEdge>, int> primMST();
     std::pair<std::vector<mstEdge>, int> kruskalMST();
+    // Parallel Boruvka minimum spanning forest; forests, if given, receives
+    // each connected component's (edges, cost)
+    std::pair<std::vector<mstEdge>, int> boruvkaMST(unsigned threads = 0,
+        std::vector<std::pair<std::vector<mstEdge>, int>>* forests = nullptr);
     
-    const std::unordered_map<std::string, std::string>& getAirportToState() const { return airportToState; }
-    const std::unordered_map<std::string, std::vector<Flight>>& getAdjList() const { return adjList; }
+    const std::vector<std::string>& getAirportCodes() const { return airportCodes; }
+    const std::vector<std::string>& getAirportStates() const { return airportStates; }
+    const CSRGraph& getGraph() { ensureFrozen(); return csr; }
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -4,6 +4,7 @@
 #include <limits>
 #include <string>
 #include <algorithm>
+#include <filesystem>
 
 using namespace std;
 
@@ -109,9 +110,23 @@ void displayMenu() {
 int main() {
     airlineGraph graph;
     
-    // Read CSV file once at startup
-    cout << "Loading airports.csv..." << endl;
-    graph.readCSV("airports.txt");
+    // Start from the binary snapshot when it is newer than the CSV; otherwise
+    // parse the CSV once and refresh the snapshot for the next launch
+    error_code binError, csvError;
+    auto binTime = filesystem::last_write_time("airports.bin", binError);
+    auto csvTime = filesystem::last_write_time("airports.txt", csvError);
+    bool snapshotFresh = !binError && !csvError && binTime >= csvTime;
+    if (snapshotFresh && graph.loadSnapshot("airports.bin")) {
+        cout << "Loaded airports.bin snapshot" << endl;
+    } else {
+        cout << "Loading airports.csv..." << endl;
+        // Never cache a failed or empty load, or it would shadow the CSV later
+        if (graph.readCSV("airports.txt") && graph.airportCount() > 0) {
+            graph.writeSnapshot("airports.bin");
+        }
+    }
+    // The graph never changes while the menu runs, so answer routes from tables
+    graph.precomputeAllPairs();
     
     while (true) {
         displayMenu();